@@ -0,0 +1,40 @@
+#ifndef Animation_H
+#define Animation_H
+
+#include <stdint.h>
+
+// Default needle speed in frames per second
+#define ANIMATION_FPS 30
+
+// Furthest the needle may trail its target, in degrees between the frames'
+// angles. The frames are not evenly spaced, so this is not a frame count.
+// Anything beyond this is skipped instead of animated.
+#define ANIMATION_MAX_LAG_DEG 45
+
+/* Set the frame the needle should sweep to
+ * @param frame The target frame, see Frames.h
+ */
+void animationSetTarget(uint8_t frame);
+
+/* Put the needle on a frame without sweeping to it
+ * @param frame The frame, see Frames.h
+ * @param now The current time in ms, the next step is due from here
+ */
+void animationJump(uint8_t frame, unsigned long now);
+
+/* Set how fast the needle sweeps
+ * @param fps Frames per second, 1 - 250
+ */
+void animationSetRate(uint8_t fps);
+
+/* Advance the needle toward its target. Never blocks.
+ * @param now The current time in ms, e.g. millis()
+ * @return the frame to show now, or FRAME_NONE if it did not move
+ */
+uint8_t animationStep(unsigned long now);
+
+/* Number of frames skipped so far to keep up with the target
+ */
+uint16_t animationDroppedFrames();
+
+#endif
@@ -0,0 +1,30 @@
+#ifndef Bench_H
+#define Bench_H
+
+/* Markers for scripts/cycle_bench.cpp. With -DBENCH on the AVR every
+ * marker is one OUT to GPIOR0, a spare register nothing else uses, which
+ * the simulator watches to time each section in cycles. Without it they
+ * compile to nothing. Sections may nest, e.g. BENCH_LED_SHOW inside
+ * BENCH_COMPASS_HEAD.
+ */
+enum BenchSection {
+  BENCH_LOOP = 1,           // One pass of loop()
+  BENCH_MAGNETOMETER,       // nextMagnetometerData()
+  BENCH_COMPASS_HEAD,       // compassHead()
+  BENCH_LED_UPDATE,         // updateLED()
+  BENCH_LED_SHOW            // Sending leds[] out
+};
+
+// Set in the marker that ends a section
+#define BENCH_END_FLAG 0x80
+
+#if defined(BENCH) and defined(__AVR__)
+#include <avr/io.h>
+#define BENCH_BEGIN(section) (GPIOR0 = (section))
+#define BENCH_END(section)   (GPIOR0 = (section) | BENCH_END_FLAG)
+#else
+#define BENCH_BEGIN(section) ((void)0)
+#define BENCH_END(section)   ((void)0)
+#endif
+
+#endif
@@ -0,0 +1,101 @@
+#ifndef Board_H
+#define Board_H
+
+#include <FastLED.h>
+
+/* Each board the firmware can drive, picked with -DBOARD_... in
+ * platformio.ini. Everything else in src/ works in layout order, the LED
+ * numbers drawn in LED.cpp, and physical[] says where on the data line
+ * each of those LEDs is. Tables that go to the LEDs are remapped with it
+ * at compile time.
+ */
+
+// The hand folded WS2812 strip. The layout was numbered along the strip,
+// so it maps one to one.
+struct FoldedStripBoard {
+  static constexpr uint8_t numLeds = 47;
+  static constexpr uint8_t dataPin = 7;
+  static constexpr EOrder colorOrder = GRB;
+  static constexpr uint8_t physical[numLeds] = {
+     0,  1,  2,  3,  4,  5,
+     6,  7,  8,  9, 10, 11, 12, 13, 14, 15,
+    16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26,
+    27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37,
+    38, 39, 40, 41, 42, 43, 44, 45, 46
+  };
+};
+
+// Altium_Designer/Minecraft_Compass_LED_Board (PCB1), 1655 (WS2812B) LEDs
+// chained U0 to U46. Entry n is the U number found at the position of
+// layout LED n in the PCB pick and place file.
+struct LedPcbBoard {
+  static constexpr uint8_t numLeds = 47;
+  static constexpr uint8_t dataPin = 7;
+  static constexpr EOrder colorOrder = GRB;
+  static constexpr uint8_t physical[numLeds] = {
+     0,  1,  2,  3,  4,  5,
+     6,  7,  8,  9, 10, 11, 12, 13, 14, 15,
+    16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26,
+    27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37,
+    38, 39, 40, 41, 42, 43, 44, 45, 46
+  };
+};
+
+// Not a real board, the strip wired backwards. The native tests build
+// with it so that a table remapped twice, or not at all, shows up.
+struct ReversedTestBoard {
+  static constexpr uint8_t numLeds = 47;
+  static constexpr uint8_t dataPin = 7;
+  static constexpr EOrder colorOrder = GRB;
+  static constexpr uint8_t physical[numLeds] = {
+    46, 45, 44, 43, 42, 41,
+    40, 39, 38, 37, 36, 35, 34, 33, 32, 31,
+    30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20,
+    19, 18, 17, 16, 15, 14, 13, 12, 11, 10,  9,
+     8,  7,  6,  5,  4,  3,  2,  1,  0
+  };
+};
+
+#if defined(BOARD_LED_PCB)
+typedef LedPcbBoard Board;
+#elif defined(BOARD_REVERSED_TEST)
+typedef ReversedTestBoard Board;
+#else
+typedef FoldedStripBoard Board;
+#endif
+
+/******************************************************** 
+* Data line position of a layout LED
+********************************************************/
+constexpr uint8_t boardLed(uint8_t layoutLed){
+  return Board::physical[layoutLed];
+}
+
+/******************************************************** 
+* Move every bit of a layout LED mask to its data line position
+********************************************************/
+constexpr uint64_t boardMask(uint64_t layoutMask){
+  uint64_t mask = 0;
+  for(uint8_t i = 0; i < Board::numLeds; i++){
+    if(layoutMask & (1ULL << i)){
+      mask |= 1ULL << Board::physical[i];
+    }
+  }
+  return mask;
+}
+
+constexpr bool boardIsPermutation(){
+  uint64_t seen = 0;
+  for(uint8_t i = 0; i < Board::numLeds; i++){
+    if(Board::physical[i] >= Board::numLeds){
+      return false;
+    }
+    seen |= 1ULL << Board::physical[i];
+  }
+  return seen == (1ULL << Board::numLeds) - 1;
+}
+
+static_assert(Board::numLeds <= 64, "LED masks are 64 bits");
+static_assert(boardIsPermutation(), "every LED needs exactly one data line position");
+
+#endif
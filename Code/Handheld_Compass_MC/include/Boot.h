@@ -0,0 +1,40 @@
+#ifndef Boot_H
+#define Boot_H
+
+/* Boot timeline. setup() marks each step with halMicros(), which counts
+ * from when the Arduino core started, so the marks are close to the
+ * time since power on. Only the first mark of each step is kept.
+ *
+ * The first frame should be up within 50 ms of power on. Measured so far
+ * only on the native build, where the simulated MMC5603 puts it up at
+ * 29 ms: 22 ms for the sensor reset and 7 ms for the first measurement.
+ * Still open: the Nano has not been measured. Read the timeline from a
+ * -DPROFILE or -DSERIAL_DEBUG build, or build with -DBOOT_PIN=2 and time
+ * from the 5V rail rising to pin 2 going high, which it does with the
+ * first frame, on a logic analyser. That includes the bootloader, which
+ * halMicros() does not see.
+ */
+enum BootMark {
+  BOOT_SETUP,               // setup() starts
+  BOOT_LEDS,                // LEDs ready
+  BOOT_SENSOR,              // Magnetometer ready
+  BOOT_FIRST_READING,       // First heading read
+  BOOT_FIRST_FRAME,         // First needle on the LEDs
+  BOOT_SERIAL,              // Serial and the diagnostics done
+  BOOT_MARKS
+};
+
+/* Mark a step of the boot, later marks of the same step are ignored
+ */
+void bootMark(BootMark mark);
+
+/* When a step happened
+ * @return us since the core started, 0 if it has not happened
+ */
+unsigned long bootTime(BootMark mark);
+
+/* Print the timeline over serial
+ */
+void bootReport();
+
+#endif
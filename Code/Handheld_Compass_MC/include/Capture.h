@@ -0,0 +1,34 @@
+#ifndef Capture_H
+#define Capture_H
+
+#include <stdint.h>
+#include "HAL.h"
+
+/* Raw magnetometer capture. Built with -DMAG_CAPTURE ([env:capture]),
+ * Magnetometer.cpp sends every reading out of the serial port, for
+ * scripts/capture.py to save and scripts/replay.py to play back.
+ *
+ * The serial stream and the file use the same format, little endian:
+ *   header  "MCAP" version
+ *   record  CAPTURE_SYNC dt x x x y y y z z z sum
+ * dt is the ms since the previous record, or since power on for the
+ * first, 65535 at most. x, y and z are the MagSample counts as signed
+ * 24 bit numbers. sum is the low byte of the sum of the 11 bytes between
+ * CAPTURE_SYNC and sum.
+ */
+#define CAPTURE_MAGIC        "MCAP"
+#define CAPTURE_VERSION      1
+#define CAPTURE_SYNC         0xA5
+#define CAPTURE_RECORD_BYTES 13
+
+/* Send the header, once before the first record
+ */
+void captureBegin();
+
+/* Send one reading, readings before captureBegin() are not sent
+ * @param now When it was read, halMillis()
+ * @param sample The reading
+ */
+void captureSample(unsigned long now, const MagSample &sample);
+
+#endif
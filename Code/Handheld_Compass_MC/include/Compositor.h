@@ -0,0 +1,41 @@
+#ifndef Compositor_H
+#define Compositor_H
+
+#include <FastLED.h>
+
+/* Overlay layers drawn on top of the needle, listed from lowest to highest
+ * priority. When two layers light the same LED the later one wins.
+ */
+enum OverlayLayer {
+  OVERLAY_SEARCHING,
+  OVERLAY_CALIBRATION,
+  OVERLAY_INTERFERENCE,
+  OVERLAY_BATTERY,
+  NUM_OVERLAYS
+};
+
+// Most LEDs a single overlay layer can light at once
+#define OVERLAY_MAX_PIXELS 8
+
+/* Light one LED on an overlay layer
+ * @param layer The overlay layer to draw on
+ * @param index The LED index, see the LED array in LED.cpp
+ * @param color The color to show on top of the needle
+ * @return false if the layer is already full or there is no such LED
+ */
+bool overlaySetPixel(OverlayLayer layer, uint8_t index, const CRGB &color);
+
+/* Remove every LED from an overlay layer
+ * @param layer The overlay layer to clear
+ */
+void overlayClear(OverlayLayer layer);
+
+/* Merge the needle and all overlay layers into the output buffer
+ * @param needle The base needle layer
+ * @param out The buffer handed to FastLED
+ * @param count The number of LEDs in both buffers
+ * @param dirty One bit per needle LED that changed, or NULL to copy them all
+ */
+void compositeFrame(const CRGB *needle, CRGB *out, uint8_t count, const uint8_t *dirty);
+
+#endif
@@ -0,0 +1,72 @@
+#ifndef ConfigStore_H
+#define ConfigStore_H
+
+#include <stdint.h>
+#include "HAL.h"
+
+/* Settings kept in EEPROM. Every block registered in CONFIG_BLOCKS is
+ * packed into one record:
+ *   sequence  uint16, +1 per record written
+ *   version   CONFIG_VERSION
+ *   stored    bit n set once block n has been saved
+ *   blocks    each block in the order of CONFIG_BLOCKS
+ *   crc       uint16, crc16() of everything before it, see Crc.h
+ * Records go round a ring of slots filling the EEPROM, one slot further
+ * each time, so every cell is written once per CONFIG_SLOTS saves.
+ * Changes are collected in RAM and written CONFIG_WRITE_DELAY ms after
+ * the last one, a byte per configPoll(), so saving never blocks loop().
+ */
+
+// Register a block here: its name and its size in bytes. The module it
+// belongs to keeps a struct of that size. The list stays in one place
+// so the record layout is fixed when the firmware is built. Bump
+// CONFIG_VERSION whenever the list or a block's layout changes, older
+// records are then ignored.
+#define CONFIG_BLOCKS(X) \
+  X(CONFIG_CALIBRATION, 8)  /* Magnetometer.cpp, hard iron offsets */ \
+  X(CONFIG_NEEDLE, 1)       /* LED.cpp, the needle mode */
+
+#define CONFIG_VERSION 2
+
+// ms without a change before the record is written
+#define CONFIG_WRITE_DELAY 2000
+
+#define CONFIG_BLOCK_NAME(name, size) name,
+#define CONFIG_BLOCK_SIZE(name, size) + (size)
+
+enum ConfigBlock {
+  CONFIG_BLOCKS(CONFIG_BLOCK_NAME)
+  CONFIG_BLOCK_COUNT
+};
+
+#define CONFIG_PAYLOAD (0 CONFIG_BLOCKS(CONFIG_BLOCK_SIZE))
+#define CONFIG_RECORD  (4 + CONFIG_PAYLOAD + 2)
+#define CONFIG_SLOTS   (HAL_EEPROM_BYTES / CONFIG_RECORD)
+
+/* Load the newest good record, call it first thing in setup()
+ */
+void configBegin();
+
+/* Copy a block out
+ * @param block Which one
+ * @param out Where to copy it
+ * @param size sizeof the block's struct, must match CONFIG_BLOCKS
+ * @return false if it was never saved, out is left alone
+ */
+bool configGet(ConfigBlock block, void *out, uint8_t size);
+
+/* Change a block, it is written once things have been quiet for
+ * CONFIG_WRITE_DELAY ms. Setting what is already there does nothing
+ * @param block Which one
+ * @param data The new contents
+ * @param size sizeof the block's struct, must match CONFIG_BLOCKS
+ */
+void configSet(ConfigBlock block, const void *data, uint8_t size);
+
+/* Write pending changes a byte at a time, call this every time through
+ * loop()
+ * @param now The current time in ms
+ */
+void configPoll(unsigned long now);
+
+#endif
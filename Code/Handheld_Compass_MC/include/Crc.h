@@ -0,0 +1,22 @@
+#ifndef Crc_H
+#define Crc_H
+
+#include <stdint.h>
+
+/* CRC-8 with polynomial 0x07 and a start of 0, as used by the telemetry
+ * frames and the warm restart state
+ * @param data The bytes to check
+ * @param length How many
+ * @return the CRC
+ */
+uint8_t crc8(const void *data, uint8_t length);
+
+/* CRC-16 with polynomial 0x1021 and a start of 0xFFFF (CCITT-FALSE), as
+ * used by the EEPROM records, where a torn write has to be caught
+ * @param data The bytes to check
+ * @param length How many
+ * @return the CRC
+ */
+uint16_t crc16(const void *data, uint8_t length);
+
+#endif
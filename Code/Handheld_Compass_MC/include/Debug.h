@@ -0,0 +1,55 @@
+#ifndef Debug_H
+#define Debug_H
+
+/* What the firmware sends over serial, picked when it is built. Each
+ * option is a constant true or false, so code behind if(DEBUG_MESSAGES)
+ * and the like is dropped by the compiler when it is off, and with it
+ * Serial and the float printing it pulls in. A build with none of the
+ * -D flags below never touches the serial port.
+ *   -DSERIAL_DEBUG  Start up messages and the sensor details
+ *   -DTELEMETRY     A binary frame per reading, see Telemetry.h
+ *   -DMAG_CAPTURE   Every raw reading, see Capture.h
+ *   -DPROFILE       Stage timings and latency histograms on request,
+ *                   see Profile.h and Latency.h
+ * TELEMETRY and MAG_CAPTURE share the port, build with one at a time.
+ *
+ * Still open: the flash and RAM this saves has not been measured. Compare
+ * the .text, .data and .bss that avr-size gives for a plain
+ * pio run -e nanoatmega328new build with those of a build from before
+ * Debug.h, which always linked Serial in.
+ */
+#ifdef SERIAL_DEBUG
+#define DEBUG_MESSAGES true
+#else
+#define DEBUG_MESSAGES false
+#endif
+
+#ifdef TELEMETRY
+#define SEND_TELEMETRY true
+#else
+#define SEND_TELEMETRY false
+#endif
+
+#ifdef MAG_CAPTURE
+#define SEND_CAPTURE true
+#else
+#define SEND_CAPTURE false
+#endif
+
+#ifdef PROFILE
+#define PROFILING true
+#else
+#define PROFILING false
+#endif
+
+// The host keeps the latency histograms for scripts/replay.cpp
+#if defined(PROFILE) or defined(HAL_NATIVE)
+#define LATENCY_STATS true
+#else
+#define LATENCY_STATS false
+#endif
+
+// Anything at all goes out of the serial port
+#define SERIAL_OUTPUT (DEBUG_MESSAGES or SEND_TELEMETRY or SEND_CAPTURE or PROFILING)
+
+#endif
@@ -0,0 +1,42 @@
+#ifndef Frames_H
+#define Frames_H
+
+#include <stdint.h>
+#include "LED.h"
+
+// Bytes needed to hold one bit per LED
+#define FRAME_BYTES ((NUM_LEDS + 7) / 8)
+
+// Needle frames are numbered clockwise around the dial starting at north.
+// NUM_FRAMES, FRAME_NORTH and FRAME_SOUTH come from frames/needle_frames.txt.
+#include "FrameTable.h"
+
+// Returned for headings that fall between two measured ranges
+#define FRAME_NONE  0xFF
+
+/* One needle image. Bit n of a mask is LED n on the data line.
+ */
+struct NeedleFrame {
+  uint8_t red[FRAME_BYTES];
+  uint8_t gray[FRAME_BYTES];
+};
+
+/* Pick the needle frame for a compass heading
+ * @param heading The heading given between 0 - 360 degrees
+ * @return the frame number, or FRAME_NONE if the heading is not covered
+ */
+uint8_t frameForHeading(float heading);
+
+/* Where a frame's needle points, the middle of its heading range
+ * @param frame The frame number, below NUM_FRAMES
+ * @return a binary angle, 65536 is a full turn clockwise from the top
+ */
+uint16_t frameAngle(uint8_t frame);
+
+/* Copy a needle frame out of flash
+ * @param frame The frame number, FRAME_NONE gives an empty frame
+ * @param out Where to store the frame
+ */
+void readFrame(uint8_t frame, NeedleFrame &out);
+
+#endif
@@ -0,0 +1,177 @@
+#ifndef HAL_H
+#define HAL_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <FastLED.h>
+
+/* Hardware abstraction layer. Everything in src/ reaches the hardware
+ * through these calls. src/hal/HAL_avr.cpp drives the real parts on the
+ * ATmega328, src/hal/HAL_native.cpp stands in for them on the host in
+ * the native PlatformIO environment.
+ */
+
+/* One magnetometer reading in raw sensor counts, zero field at 0.
+ * The MMC5603 gives 0.00625 uT per count.
+ */
+struct MagSample {
+  int32_t x;
+  int32_t y;
+  int32_t z;
+};
+
+#define MAG_UT_PER_COUNT 0.00625f
+
+/******************************************************** 
+* LED sink
+********************************************************/
+
+/* Hand the LED buffer to the LED driver
+ * @param leds The buffer to send, in data line order
+ * @param count The number of LEDs
+ */
+void halLedBegin(CRGB *leds, uint8_t count);
+
+/* Send the LED buffer to the LEDs
+ */
+void halLedShow();
+
+/******************************************************** 
+* Magnetometer source
+********************************************************/
+
+/* Start the magnetometer
+ * @return false if it did not answer
+ */
+bool halMagBegin();
+
+/* Take one reading, waiting for it
+ * @param out Where to store the reading
+ * @return false if the reading failed
+ */
+bool halMagRead(MagSample &out);
+
+/* How a reading started with halMagRequest() is getting on
+ */
+enum MagStatus {
+  MAG_BUSY,                 // The sensor is measuring or the bus is moving it
+  MAG_READY,
+  MAG_FAILED
+};
+
+/* Start a reading and return straight away, the sensor and the bus work
+ * on it while the caller does something else
+ * @return false if it could not be started
+ */
+bool halMagRequest();
+
+/* Move a reading along, call it every time through loop() until it is
+ * no longer MAG_BUSY. Never waits
+ * @param out Where to store the reading once it is MAG_READY
+ */
+MagStatus halMagPoll(MagSample &out);
+
+/* Print what the magnetometer reports about itself
+ */
+void halMagPrintDetails();
+
+// Timed sampling runs on a tick this long, in ms
+#define HAL_SAMPLE_TICK_MS 2
+
+// From starting a timed measurement to reading it, the slowest takes 7
+#define HAL_SAMPLE_MEASURE_MS 8
+
+// A timed measurement that is not in yet is looked at again on the next
+// tick, at most this many times, before it goes in as failed
+#define HAL_SAMPLE_RETRIES 2
+
+struct SampleRing;
+
+/* Take a reading every period ms on a hardware timer, whatever loop() is
+ * doing, and add each to ring, see SampleRing.h. A measurement starts on
+ * a timer tick and is read HAL_SAMPLE_MEASURE_MS later, a reading that
+ * fails goes in with ok false. The first comes one period from now.
+ * Start the sensor with halMagBegin() first, and stop this before
+ * starting it again
+ * @param period A multiple of HAL_SAMPLE_TICK_MS, over
+ * HAL_SAMPLE_MEASURE_MS and the retries after it
+ * @param ring Where the readings go
+ */
+void halMagSampleStart(uint16_t period, SampleRing &ring);
+
+/* Stop timed sampling, nothing is added to the ring after this
+ */
+void halMagSampleStop();
+
+/******************************************************** 
+* Clock
+********************************************************/
+
+/* Milliseconds since power on
+ */
+unsigned long halMillis();
+
+/* Microseconds since power on
+ */
+unsigned long halMicros();
+
+/* Wait
+ * @param ms How long to wait in milliseconds
+ */
+void halDelay(unsigned long ms);
+
+/******************************************************** 
+* EEPROM
+********************************************************/
+
+// Size of the EEPROM, the ATmega328 has 1 KB
+#define HAL_EEPROM_BYTES 1024
+
+/* Read one byte
+ * @param address 0 - HAL_EEPROM_BYTES - 1
+ */
+uint8_t halEepromRead(uint16_t address);
+
+/* Whether a write can start without waiting for the last one
+ */
+bool halEepromReady();
+
+/* Start writing one byte, a byte that already holds the value is left
+ * alone. A write takes about 3.4 ms, check halEepromReady() first or
+ * this waits for the one before it
+ * @param address 0 - HAL_EEPROM_BYTES - 1
+ * @param value The byte to write
+ */
+void halEepromWrite(uint16_t address, uint8_t value);
+
+/******************************************************** 
+* Serial sink
+********************************************************/
+
+/* Open the serial port and wait for it to be ready
+ * @param baud The baud rate
+ */
+void halSerialBegin(unsigned long baud);
+
+/* Write raw bytes
+ * @return how many bytes were written
+ */
+size_t halSerialWrite(const uint8_t *data, size_t length);
+
+/* How many bytes can be written without waiting
+ */
+size_t halSerialAvailableForWrite();
+
+/* Print text or a number
+ */
+void halSerialPrint(const char *text);
+void halSerialPrint(double value);
+void halSerialPrint(long value);
+void halSerialPrintln(const char *text = "");
+
+/* Read one byte that came in
+ * @return the byte, or -1 if nothing is waiting
+ */
+int halSerialRead();
+
+#endif
@@ -1,6 +1,21 @@
 #ifndef LED_H
 #define LED_H
 
+#include "Board.h"
+
+// How many leds in your strip?
+#define NUM_LEDS 47
+
+static_assert(Board::numLeds == NUM_LEDS, "the board must have an LED for every layout position");
+
+// How the needle follows the heading
+enum NeedleMode {
+  NEEDLE_SNAP,      // Jump straight to the frame for the heading
+  NEEDLE_ANIMATED,  // Sweep through the frames in between
+  NEEDLE_PHYSICAL,  // Follow the heading on a spring, with overshoot
+  NEEDLE_RASTER     // Draw the needle at the exact heading, blended
+};
+
 /* Setup the LEDs
 */
 void setupLED();
@@ -14,4 +29,41 @@ void testLED();
  */
 void compassHead(float heading);
 
+/* Move an animated needle along, call this every time through loop()
+ */
+void updateLED();
+
+/* Choose how the needle follows the heading
+ * @param mode See NeedleMode
+ */
+void setNeedleMode(NeedleMode mode);
+
+/* The needle frame on the LEDs right now, see Frames.h
+ * @return the frame, FRAME_NONE when there is none or the rasterizer drew it
+ */
+uint8_t shownFrame();
+
+// ms per frame of the spin shown while searching for the magnetometer
+#define SEARCH_STEP_MS 25
+
+// LED lit on top of the spin while searching, the center, and its color
+#define SEARCH_LED   21
+#define SEARCH_COLOR CRGB::Blue
+
+/* Spin the needle, like the compass in the Nether, while there is no
+ * heading to show, with SEARCH_LED lit on an overlay. updateLED() draws it
+ * @param on true while the magnetometer is missing
+ */
+void setSearching(bool on);
+
+/* Put a frame back on the LEDs after a warm restart, the animation
+ * carries on from it
+ * @param frame See Frames.h, anything else is ignored
+ */
+void resumeNeedle(uint8_t frame);
+
+/* Redraw the current needle with the overlays, e.g. after an overlay changed
+ */
+void refreshLED();
+
 #endif
\ No newline at end of file
@@ -0,0 +1,72 @@
+#ifndef Latency_H
+#define Latency_H
+
+#include <stdint.h>
+
+/* Latency histograms in halMicros() time, kept with -DPROFILE and always
+ * on the host, see Debug.h. Each is LATENCY_BUCKETS 16 bit counts that
+ * stop at 65535, 32 bytes. Bucket 0 holds everything under 256 us and
+ * every bucket after it is twice as wide as the one before, so bucket b
+ * starts at 128 << b us, and the last one holds everything from 4.2 s on.
+ */
+enum LatencyHistogram {
+  LATENCY_PERIOD,           // From one reading to the next
+  LATENCY_AGE,              // Age of the newest reading at each LED show
+  LATENCY_CHANGE,           // From a reading that moves the needle to the show that moves it
+  LATENCY_BUS,              // From start to stop of each magnetometer I2C transaction
+  LATENCY_HISTOGRAMS
+};
+
+#define LATENCY_BUCKETS 16
+
+/* A reading came in, Magnetometer.cpp calls this
+ * @param us When the sensor took it, in halMicros() time
+ */
+void latencySample(unsigned long us);
+
+/* The frame the latest reading asks for, compassHead() calls this
+ * @param frame See Frames.h, FRAME_NONE is ignored
+ */
+void latencyTarget(uint8_t frame);
+
+/* The LEDs were just shown
+ */
+void latencyShow();
+
+/* A magnetometer transaction finished, the AVR HAL calls this
+ * @param us How long it had the bus
+ */
+void latencyBus(unsigned long us);
+
+/* Which bucket a time goes in
+ * @param us The time in us
+ * @return the bucket, 0 - LATENCY_BUCKETS - 1
+ */
+uint8_t latencyBucket(unsigned long us);
+
+/* Where a bucket starts
+ * @param bucket 0 - LATENCY_BUCKETS - 1
+ * @return the shortest time in it, in us
+ */
+unsigned long latencyBucketStart(uint8_t bucket);
+
+/* The counts of one histogram
+ * @return LATENCY_BUCKETS counts
+ */
+const uint16_t *latencyCounts(LatencyHistogram which);
+
+/* The bucket a percentile of the times falls in
+ * @param percent 1 - 100
+ * @return the bucket, or LATENCY_BUCKETS if the histogram is empty
+ */
+uint8_t latencyPercentile(LatencyHistogram which, uint8_t percent);
+
+/* Print the histograms over serial
+ */
+void latencyReport();
+
+/* Clear the histograms
+ */
+void latencyReset();
+
+#endif
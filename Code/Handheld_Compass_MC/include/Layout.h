@@ -0,0 +1,196 @@
+#ifndef Layout_H
+#define Layout_H
+
+#include <stdint.h>
+#include "LED.h"
+
+/* The LEDs sit on an 11 x 5 grid, see the LED array in LED.cpp. The strip
+ * starts at the bottom row and snakes up, so every row runs the opposite
+ * way to the one below it. Everything here is worked out by the compiler.
+ * The tables hold data line positions for the board, see Board.h.
+ */
+#define LAYOUT_WIDTH    11
+#define LAYOUT_HEIGHT   5
+#define LAYOUT_CENTER_X 5
+#define LAYOUT_CENTER_Y 2
+#define LAYOUT_NONE     0xFF
+
+struct LayoutRow {
+  uint8_t count;      // LEDs in the row
+  uint8_t left;       // Column of the leftmost LED
+  bool rightToLeft;   // Direction the strip runs along the row
+};
+
+// Rows in strip order, bottom row first
+constexpr LayoutRow layoutRows[LAYOUT_HEIGHT] = {
+  { 6, 2, false},   // 00 - 05
+  {10, 0, true},    // 06 - 15
+  {11, 0, false},   // 16 - 26
+  {11, 0, true},    // 27 - 37
+  { 9, 1, false}    // 38 - 46
+};
+
+// Grid position of an LED, column from the left and row from the top
+struct LedCoord {
+  int8_t x;
+  int8_t y;
+};
+
+struct LayoutTables {
+  LedCoord coord[NUM_LEDS];
+  uint8_t index[LAYOUT_HEIGHT][LAYOUT_WIDTH];
+};
+
+/******************************************************** 
+* Walk the rows in strip order to place every LED
+********************************************************/
+constexpr LayoutTables makeLayoutTables(){
+  LayoutTables t = {};
+
+  for(uint8_t y = 0; y < LAYOUT_HEIGHT; y++){
+    for(uint8_t x = 0; x < LAYOUT_WIDTH; x++){
+      t.index[y][x] = LAYOUT_NONE;
+    }
+  }
+
+  uint8_t led = 0;
+  for(uint8_t r = 0; r < LAYOUT_HEIGHT; r++){
+    const LayoutRow &row = layoutRows[r];
+    int8_t y = LAYOUT_HEIGHT - 1 - r;
+
+    for(uint8_t n = 0; n < row.count; n++){
+      int8_t x = row.rightToLeft ? row.left + row.count - 1 - n : row.left + n;
+      t.coord[boardLed(led)] = {x, y};
+      t.index[y][x] = boardLed(led);
+      led++;
+    }
+  }
+  return t;
+}
+
+constexpr LayoutTables layoutTables = makeLayoutTables();
+
+/******************************************************** 
+* Compile time checks of the row description
+********************************************************/
+constexpr uint8_t layoutCount(){
+  uint8_t total = 0;
+  for(uint8_t r = 0; r < LAYOUT_HEIGHT; r++){
+    total += layoutRows[r].count;
+  }
+  return total;
+}
+
+constexpr bool layoutRowsFit(){
+  for(uint8_t r = 0; r < LAYOUT_HEIGHT; r++){
+    if(layoutRows[r].left + layoutRows[r].count > LAYOUT_WIDTH){
+      return false;
+    }
+  }
+  return true;
+}
+
+constexpr bool layoutRowsAlternate(){
+  for(uint8_t r = 1; r < LAYOUT_HEIGHT; r++){
+    if(layoutRows[r].rightToLeft == layoutRows[r - 1].rightToLeft){
+      return false;
+    }
+  }
+  return true;
+}
+
+constexpr bool layoutRoundTrips(){
+  for(uint8_t i = 0; i < NUM_LEDS; i++){
+    LedCoord c = layoutTables.coord[boardLed(i)];
+    if(layoutTables.index[c.y][c.x] != boardLed(i)){
+      return false;
+    }
+  }
+  return true;
+}
+
+static_assert(layoutCount() == NUM_LEDS, "layout rows must add up to NUM_LEDS");
+static_assert(layoutRowsFit(), "a layout row runs off the grid");
+static_assert(layoutRowsAlternate(), "the strip snakes, rows must alternate direction");
+static_assert(layoutRoundTrips(), "two LEDs share a grid position");
+static_assert(layoutTables.index[LAYOUT_CENTER_Y][LAYOUT_CENTER_X] == boardLed(21), "LED 21 is the center");
+
+/******************************************************** 
+* Integer atan2 for compile time tables, CORDIC in vectoring mode.
+* Returns a binary angle (65536 is a full turn) clockwise from straight up.
+********************************************************/
+constexpr int32_t cordicAngles[16] = {
+  2097152, 1238021, 654136, 332050, 166669, 83416, 41718, 20860,
+  10430, 5215, 2608, 1304, 652, 326, 163, 81
+};  // atan(2^-i) in 1/256ths of a binary angle step
+
+constexpr uint16_t layoutAngle(int8_t dx, int8_t dy){
+  int32_t x = (int32_t)dy * 4096;   // rotate so straight up is angle 0
+  int32_t y = (int32_t)dx * 4096;
+  int32_t angle = 0;
+
+  if(x < 0){
+    x = -x;
+    y = -y;
+    angle = (int32_t)32768 * 256;
+  }
+
+  for(uint8_t i = 0; i < 16; i++){
+    int32_t nx = 0;
+    if(y > 0){
+      nx = x + (y >> i);
+      y = y - (x >> i);
+      angle += cordicAngles[i];
+    }else{
+      nx = x - (y >> i);
+      y = y + (x >> i);
+      angle -= cordicAngles[i];
+    }
+    x = nx;
+  }
+
+  if(angle < 0){
+    angle += (int32_t)65536 * 256;
+  }
+  return (uint16_t)((angle + 128) / 256);
+}
+
+/******************************************************** 
+* Integer square root for compile time tables
+********************************************************/
+constexpr uint16_t layoutSqrt(uint32_t v){
+  uint32_t r = 0;
+  while((r + 1) * (r + 1) <= v){
+    r++;
+  }
+  if(v - r * r > r){
+    r++;   // round to nearest
+  }
+  return r;
+}
+
+// CORDIC is good to a few binary angle steps, well under 0.1 degree
+constexpr bool layoutAngleNear(uint16_t a, uint16_t b){
+  return (int16_t)(a - b) >= -8 and (int16_t)(a - b) <= 8;
+}
+
+static_assert(layoutAngleNear(layoutAngle(0, 1), 0), "straight up is angle 0");
+static_assert(layoutAngleNear(layoutAngle(1, 1), 8192), "up and right is an eighth of a turn");
+static_assert(layoutAngleNear(layoutAngle(1, 0), 16384), "right is a quarter turn");
+static_assert(layoutAngleNear(layoutAngle(0, -1), 32768), "straight down is half a turn");
+static_assert(layoutAngleNear(layoutAngle(-1, 0), 49152), "left is three quarters of a turn");
+
+/* Grid position of an LED
+ * @param index The LED position on the data line
+ * @return the column from the left and the row from the top
+ */
+LedCoord ledCoord(uint8_t index);
+
+/* LED at a grid position
+ * @param x Column from the left
+ * @param y Row from the top
+ * @return the LED position on the data line, or LAYOUT_NONE if there is none
+ */
+uint8_t ledIndex(int8_t x, int8_t y);
+
+#endif
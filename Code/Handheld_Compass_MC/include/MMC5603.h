@@ -0,0 +1,48 @@
+#ifndef MMC5603_H
+#define MMC5603_H
+
+#include <stdint.h>
+#include "HAL.h"
+
+/* The MMC5603 register map, as far as the firmware uses it. Shared by
+ * the HALs that talk to the part and the simulated one in MMC5603Sim.h.
+ */
+#define MMC5603_ADDRESS     0x30
+#define MMC5603_XOUT0       0x00
+#define MMC5603_TOUT        0x09
+#define MMC5603_STATUS      0x18
+#define MMC5603_ODR         0x1A
+#define MMC5603_CTRL0       0x1B
+#define MMC5603_CTRL1       0x1C
+#define MMC5603_CTRL2       0x1D
+#define MMC5603_PRODUCT_ID  0x39
+#define MMC5603_ID          0x10
+
+#define MMC5603_TM_M        0x01  // CTRL0, take a magnetic measurement
+#define MMC5603_TM_T        0x02  // CTRL0, take a temperature measurement
+#define MMC5603_DO_SET      0x08  // CTRL0, set pulse
+#define MMC5603_DO_RESET    0x10  // CTRL0, reset pulse
+#define MMC5603_CMM_FREQ    0x80  // CTRL0, take the rate from ODR
+#define MMC5603_BW_MASK     0x03  // CTRL1
+#define MMC5603_SW_RESET    0x80  // CTRL1
+#define MMC5603_CMM_EN      0x10  // CTRL2, measure continuously
+#define MMC5603_MEAS_M_DONE 0x40  // STATUS
+#define MMC5603_MEAS_T_DONE 0x80  // STATUS
+
+#define MMC5603_COUNTS_PER_UT 160  // 0.00625 uT per count
+#define MMC5603_ZERO          (1L << 19)
+
+// Bytes from MMC5603_XOUT0 that hold the three 20 bit outputs
+#define MMC5603_DATA_BYTES  9
+
+/* Turn the output registers into a reading
+ * @param b MMC5603_DATA_BYTES bytes read from MMC5603_XOUT0
+ * @param out The reading in counts, zero field at 0
+ */
+inline void mmc5603Decode(const uint8_t *b, MagSample &out){
+  out.x = (((int32_t)b[0] << 12) | ((int32_t)b[1] << 4) | (b[6] >> 4)) - MMC5603_ZERO;
+  out.y = (((int32_t)b[2] << 12) | ((int32_t)b[3] << 4) | (b[7] >> 4)) - MMC5603_ZERO;
+  out.z = (((int32_t)b[4] << 12) | ((int32_t)b[5] << 4) | (b[8] >> 4)) - MMC5603_ZERO;
+}
+
+#endif
@@ -0,0 +1,85 @@
+#ifndef MMC5603Sim_H
+#define MMC5603Sim_H
+
+#include <stdint.h>
+#include "MMC5603.h"
+
+/* A software MMC5603 for the host, never built into the firmware. It has
+ * the register map in MMC5603.h and answers byte by byte like the part
+ * does on I2C, so it can sit behind the native HAL or on simavr's TWI
+ * bus. What it measures is set with a field script, a list
+ * of key=value settings split by spaces:
+ *
+ *   heading=DEG        where the compass points at the start, default 0
+ *   spin=DEG_PER_S     turn at a steady rate
+ *   swing=DEG,SECONDS  swing either side of heading and back
+ *   trace=FILE         follow a "<ms> <heading>" file, in between is interpolated
+ *   field=UT           horizontal field, default 40
+ *   down=UT            vertical field on Z, default 0
+ *   hard=X,Y,Z         hard iron offset in uT, default the firmware's
+ *                      OFFSET_X and OFFSET_y so its calibration is right
+ *   soft=XX,XY,XZ,YX,YY,YZ,ZX,ZY,ZZ  soft iron matrix, default identity
+ *   noise=UT           gaussian noise on every axis, one sigma
+ *   spikes=RATE,UT     chance per measurement of a spike of that size
+ *   temp=C,C_PER_S     die temperature at the start and how it changes
+ *   drift=UT_PER_C     offset on every axis per degree away from 25 C
+ *   nack=RATE          chance that the part does not answer its address
+ *   seed=N             noise, spikes and nacks repeat for the same seed
+ *   unplug=S,S         off the bus from the first time to the second, in s
+ *
+ * The register map is in MMC5603.h.
+ */
+
+/* Set up the simulated part
+ * @param script The field script, see above, NULL for the defaults
+ * @return false if the script has a setting it does not know, the
+ *         settings before it are kept
+ */
+bool simMagConfigure(const char *script);
+
+/* Tell the part what time it is, the field follows the script in time
+ * @param ms Time since power on in milliseconds
+ */
+void simMagSetTime(unsigned long ms);
+
+/* Plug the part in or take it off the bus
+ */
+void simMagSetPresent(bool present);
+
+/********************************************************
+* I2C, one call per bus event
+********************************************************/
+
+/* A start or repeated start with an address byte
+ * @param address The 7 bit address
+ * @param read true for a read
+ * @return true if the part acknowledged
+ */
+bool simMagStart(uint8_t address, bool read);
+
+/* A byte written by the master
+ * @return true if the part acknowledged
+ */
+bool simMagWriteByte(uint8_t data);
+
+/* A byte read by the master
+ */
+uint8_t simMagReadByte();
+
+/* A stop
+ */
+void simMagStop();
+
+/********************************************************
+* What the simulation knows
+********************************************************/
+
+/* The heading the script is at right now, in degrees
+ */
+float simMagHeading();
+
+/* How many magnetic measurements have been taken
+ */
+unsigned long simMagMeasurements();
+
+#endif
@@ -1,14 +1,75 @@
 #ifndef Magnetometer_H
 #define Magnetometer_H
 
-/* Setup the Magnetometer
+#include <stdint.h>
+
+//Magnetic offsets in micro-Tesla, the defaults until set at run time
+#define OFFSET_X -62.28
+#define OFFSET_y 140.35
+
+/* Setup the Magnetometer, without touching serial so the first heading
+* can be shown as soon as possible. A missing sensor does not stop the
+* compass, see retryMagnetometer()
 */
 void setupMagnetometer();
 
-/* Get the data from the magenetometer to get a heading
-* @param debug_flag Set to true to print data to console, else set to false
-* @return return the heading 0-360 degrees
+/* Start the sensor again if it is missing and its wait is over. The wait
+* doubles after every failed try, call this every time through loop()
+* @param now The current time in ms
+*/
+void retryMagnetometer(unsigned long now);
+
+/* Whether the sensor is answering
+*/
+bool magnetometerReady();
+
+/* Start serial for the builds that use it, print the sensor details and
+* send the capture header, see Debug.h. Call it after setupMagnetometer()
+*/
+void setupMagnetometerSerial();
+
+/* Get the data from the magenetometer to get a heading, waiting for it.
+* Built with -DTELEMETRY the reading also goes out as telemetry, see
+* Debug.h
+* @return return the heading 0-360 degrees, NAN if the sensor is missing
+*/
+float getMagnetometerData();
+
+/* Take a reading every period ms on a hardware timer from now on, into a
+* ring that nextMagnetometerData() empties, see SampleRing.h. The timing
+* no longer depends on how long loop() takes
+* @param period In ms, see halMagSampleStart()
+*/
+void startMagnetometerSampling(uint16_t period);
+
+/* Take the oldest good reading off the ring, call it until it returns
+* false every time through loop(). Failed readings are skipped, and
+* MAG_FAILED_READINGS of them in a row restart the sensor
+* @param heading Gets the heading 0-360 degrees
+* @param taken Gets when the sensor took the reading, in halMicros() time
+* @return false when the ring is empty
+*/
+bool nextMagnetometerData(float &heading, unsigned long &taken);
+
+/* Readings dropped because loop() let the ring fill up
+*/
+unsigned long magnetometerDropped();
+
+/* Set the hard iron offsets the heading is worked out with, they are
+* saved to EEPROM and used from then on
+* @param x, y In micro-Tesla
+*/
+void setMagnetometerOffsets(float x, float y);
+
+/* Use hard iron offsets without saving them, e.g. ones that are already
+* in EEPROM or only held over a reset
+* @param x, y In micro-Tesla
+*/
+void applyMagnetometerOffsets(float x, float y);
+
+/* The hard iron offsets in use
+* @param x, y Filled in, micro-Tesla
 */
-float getMagnetometerData(bool debug_flag);
+void getMagnetometerOffsets(float &x, float &y);
 
 #endif
\ No newline at end of file
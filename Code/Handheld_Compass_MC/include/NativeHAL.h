@@ -0,0 +1,55 @@
+#ifndef NativeHAL_H
+#define NativeHAL_H
+
+#include "HAL.h"
+
+/* Hooks into the native HAL, only built with -DHAL_NATIVE. The host
+ * program drives the clock and decides what the magnetometer sees.
+ */
+
+/* Called for every magnetometer reading
+ * @param now The virtual time in milliseconds
+ * @param out The reading to fill in
+ * @return false to make the reading fail
+ */
+typedef bool (*NativeMagSource)(unsigned long now, MagSample &out);
+
+/* Called every time the LEDs are shown
+ * @param leds The LED buffer, in data line order
+ * @param count The number of LEDs
+ * @param now The virtual time in milliseconds
+ */
+typedef void (*NativeShowHook)(const CRGB *leds, uint8_t count, unsigned long now);
+
+/* Move the virtual clock forward
+ * @param ms How far to move it in milliseconds
+ */
+void halNativeAdvance(unsigned long ms);
+
+/* Set where magnetometer readings come from, NULL reads the simulated
+ * MMC5603 over its registers, see MMC5603Sim.h
+ */
+void halNativeSetMagSource(NativeMagSource source);
+
+/* Set who gets told when the LEDs are shown, NULL for nobody
+ */
+void halNativeOnShow(NativeShowHook hook);
+
+/* Turn the serial output on or off, it is on by default
+ */
+void halNativeSerialEcho(bool on);
+
+/* The EEPROM, HAL_EEPROM_BYTES bytes that start out as 0xFF. A host
+ * program can fill it before setup() or look at it afterwards
+ */
+uint8_t *halNativeEeprom();
+
+/* Write the LEDs out as text, R for red, B for blue, G for gray or any
+ * other colour, . for off
+ * @param leds The LED buffer, in data line order
+ * @param count The number of LEDs
+ * @param out At least count + 1 chars, gets a terminated string
+ */
+void halNativeLedText(const CRGB *leds, uint8_t count, char *out);
+
+#endif
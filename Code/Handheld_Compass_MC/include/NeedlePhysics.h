@@ -0,0 +1,55 @@
+#ifndef NeedlePhysics_H
+#define NeedlePhysics_H
+
+#include <stdint.h>
+
+// Length of one integration step in ms
+#define PHYSICS_TICK_MS 20
+
+// Default spring and damping, Q8.8 per tick (0.05 and 0.12)
+#define PHYSICS_SPRING  13
+#define PHYSICS_DAMPING 31
+
+// Everything the needle needs to carry on after a reset, see WarmStart.h
+struct PhysicsState {
+  uint32_t position;        // Q16.16 binary angle
+  int32_t velocity;         // Q16.16 binary angle per tick
+  uint16_t target;          // binary angle
+  bool started;
+};
+
+/* Set the heading the needle is pulled toward
+ * @param heading The heading given between 0 - 360 degrees, NaN or
+ * infinity is ignored
+ */
+void physicsSetTarget(float heading);
+
+/* Tune the needle
+ * @param spring Pull toward the target, Q8.8 per tick, at most 64
+ * @param damping Fraction of the speed lost each tick, Q8.8
+ */
+void physicsSetTuning(uint8_t spring, uint8_t damping);
+
+/* Run as many fixed steps as are due
+ * @param now The current time in ms, e.g. millis()
+ * @return true if the needle moved
+ */
+bool physicsStep(unsigned long now);
+
+/* Copy out the needle's state
+ * @param out Filled in
+ */
+void physicsSave(PhysicsState &out);
+
+/* Put the needle back where it was
+ * @param state From physicsSave()
+ * @param now The current time in ms, steps are due from here
+ */
+void physicsRestore(const PhysicsState &state, unsigned long now);
+
+/* The heading the needle is showing
+ * @return the heading between 0 - 360 degrees
+ */
+float physicsHeading();
+
+#endif
@@ -0,0 +1,28 @@
+#ifndef Pack_H
+#define Pack_H
+
+#include <stdint.h>
+
+/* Little endian writers for the records sent over serial, see Capture.h
+ * and Telemetry.h. Each stores value at p and returns the byte after it.
+ */
+
+inline uint8_t *put16(uint8_t *p, uint16_t value){
+  p[0] = value;
+  p[1] = value >> 8;
+  return p + 2;
+}
+
+// The low 3 bytes, a magnetometer axis fits with its sign
+inline uint8_t *put24(uint8_t *p, int32_t value){
+  p[0] = value;
+  p[1] = value >> 8;
+  p[2] = value >> 16;
+  return p + 3;
+}
+
+inline uint8_t *put32(uint8_t *p, uint32_t value){
+  return put16(put16(p, value), value >> 16);
+}
+
+#endif
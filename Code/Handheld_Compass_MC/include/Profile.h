@@ -0,0 +1,58 @@
+#ifndef Profile_H
+#define Profile_H
+
+#include <stdint.h>
+
+/* Hot path profiling. With -DPROFILE on the AVR ([env:profile]) Timer1
+ * counts at 2 MHz, 0.5 us a tick, and the probes below read it: a begin
+ * is two loads and two stores, an end adds a subtract, about 8 and 14
+ * cycles. An end keeps only the ticks of the last run of its stage, and
+ * profileCommit() at the end of loop() folds them into the count, min,
+ * max and sum, away from the hot path. A run must take under 32 ms,
+ * when Timer1 wraps, and one too short to see (0 ticks) is not counted.
+ * Without -DPROFILE the probes compile to nothing.
+ *
+ * Timer1 is taken over for this, so analogWrite() on pins 9 and 10 does
+ * not work in a profiling build. Nothing on the compass uses them.
+ */
+enum ProfileStage {
+  PROFILE_READ,             // Taking a reading off the ring in nextMagnetometerData()
+  PROFILE_HEADING,          // The heading math in Magnetometer.cpp
+  PROFILE_FRAME,            // frameForHeading()
+  PROFILE_SHOW,             // Sending leds[] out
+  PROFILE_IDLE,             // A pass through loop() with no heading to show
+  PROFILE_STAGES
+};
+
+// Timer1 ticks per us
+#define PROFILE_TICKS_PER_US 2
+
+#if defined(PROFILE) and defined(__AVR__)
+#include <avr/io.h>
+extern uint16_t profileStart[PROFILE_STAGES];
+extern uint16_t profileTicks[PROFILE_STAGES];
+#define PROFILE_BEGIN(stage) (profileStart[stage] = TCNT1)
+#define PROFILE_END(stage)   (profileTicks[stage] = TCNT1 - profileStart[stage])
+#else
+#define PROFILE_BEGIN(stage) ((void)0)
+#define PROFILE_END(stage)   ((void)0)
+#endif
+
+/* Start Timer1 running free at 2 MHz and clear the table
+ */
+void profileBegin();
+
+/* Fold the stages that ran since the last call into the table, call this
+ * at the end of loop()
+ */
+void profileCommit();
+
+/* Print count, min, avg and max in us for every stage over serial
+ */
+void profileReport();
+
+/* Clear the table
+ */
+void profileReset();
+
+#endif
@@ -0,0 +1,14 @@
+#ifndef Rasterizer_H
+#define Rasterizer_H
+
+#include <FastLED.h>
+
+/* Draw the needle at any angle, blending the LEDs it only partly covers
+ * @param angle Where the needle points, 65536 is a full turn clockwise from the top
+ * @param needle The needle layer to draw into, NUM_LEDS long
+ * @param dirty One bit per LED, set for every LED that changed
+ * @return true if any LED changed
+ */
+bool rasterizeNeedle(uint16_t angle, CRGB *needle, uint8_t *dirty);
+
+#endif
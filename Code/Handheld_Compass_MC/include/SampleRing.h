@@ -0,0 +1,87 @@
+#ifndef SampleRing_H
+#define SampleRing_H
+
+#include <stdint.h>
+#include "HAL.h"
+
+/* Single producer, single consumer ring of magnetometer readings, from
+ * the sampling interrupt in the HAL to loop(). Neither side turns the
+ * interrupts off. Each index is one byte written by one side only, and
+ * a byte load or store cannot be torn on the AVR, so the only ordering
+ * needed is that a slot is written before head moves past it and read
+ * before tail does. The fences below keep the compiler from moving the
+ * slot copy across the index, the CPU does not reorder.
+ *
+ * head and tail run free and wrap at 256, the ring is full when they are
+ * SAMPLE_RING apart. A reading that finds it full is dropped and counted
+ * in dropped, which also wraps at 256, see ringDropped().
+ */
+
+// A power of two, at most 128
+#define SAMPLE_RING 4
+
+struct MagReading {
+  unsigned long ms;         // halMillis() when the measurement was started
+  unsigned long us;         // halMicros() then
+  MagSample sample;
+  bool ok;                  // false if the sensor did not answer
+};
+
+struct SampleRing {
+  MagReading slots[SAMPLE_RING];
+  volatile uint8_t head;    // Next slot to fill, the producer's
+  volatile uint8_t tail;    // Next slot to take, the consumer's
+  volatile uint8_t dropped; // Readings that found it full, the producer's
+};
+
+static_assert((SAMPLE_RING & (SAMPLE_RING - 1)) == 0 and SAMPLE_RING <= 128,
+              "SAMPLE_RING is a power of two up to 128");
+
+/* Add a reading, producer side only
+ * @return false if the ring was full, the reading is counted in dropped
+ */
+inline bool ringPush(SampleRing &ring, const MagReading &reading){
+  uint8_t head = ring.head;
+  if((uint8_t)(head - ring.tail) == SAMPLE_RING){
+    ring.dropped = ring.dropped + 1;
+    return false;
+  }
+  ring.slots[head & (SAMPLE_RING - 1)] = reading;
+  __atomic_signal_fence(__ATOMIC_RELEASE);
+  ring.head = head + 1;
+  return true;
+}
+
+/* Take the oldest reading, consumer side only
+ * @return false if there was none
+ */
+inline bool ringPop(SampleRing &ring, MagReading &reading){
+  uint8_t tail = ring.tail;
+  if(ring.head == tail){
+    return false;
+  }
+  __atomic_signal_fence(__ATOMIC_ACQUIRE);
+  reading = ring.slots[tail & (SAMPLE_RING - 1)];
+  __atomic_signal_fence(__ATOMIC_RELEASE);
+  ring.tail = tail + 1;
+  return true;
+}
+
+/* Readings dropped since the last call, consumer side only
+ * @param seen The count at the last call, kept by the caller
+ */
+inline uint8_t ringDropped(const SampleRing &ring, uint8_t &seen){
+  uint8_t now = ring.dropped;
+  uint8_t dropped = now - seen;
+  seen = now;
+  return dropped;
+}
+
+/* Empty the ring, only while nothing is producing
+ */
+inline void ringClear(SampleRing &ring){
+  ring.head = 0;
+  ring.tail = 0;
+}
+
+#endif
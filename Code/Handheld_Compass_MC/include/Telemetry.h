@@ -0,0 +1,53 @@
+#ifndef Telemetry_H
+#define Telemetry_H
+
+#include <stdint.h>
+#include "HAL.h"
+
+/* Binary telemetry, one frame per reading. Frames are queued in a ring
+ * buffer and moved to the serial port only as fast as it takes them, so
+ * sending never waits. A frame that does not fit is dropped and counted.
+ *
+ * Each frame is COBS encoded and ends in a 0 byte. Decoded it is
+ * TELEMETRY_PAYLOAD bytes, little endian:
+ *   0  version          TELEMETRY_VERSION
+ *   1  sequence         uint16, +1 per frame sent or dropped
+ *   3  time             uint32, ms since power on of the reading
+ *   7  x, y, z          signed 24 bit raw counts each, see MagSample
+ *   16 heading          uint16, hundredths of a degree, 0xFFFF for none
+ *   18 frame            the needle frame on the LEDs, see Frames.h
+ *   19 read time        uint16, us from the reading to loop() taking it
+ *   21 draw time        uint16, us spent in compassHead()
+ *   23 dropped          frames dropped since the last one sent, 255 at most
+ *   24 crc              crc8() of bytes 0 - 23, see Crc.h
+ * scripts/telemetry_decode.cpp turns the stream into CSV.
+ */
+#define TELEMETRY_VERSION  1
+#define TELEMETRY_PAYLOAD  25
+#define TELEMETRY_ENCODED  (TELEMETRY_PAYLOAD + 2)  // COBS code byte and the 0
+#define TELEMETRY_NO_HEADING 0xFFFF
+
+// Bytes waiting for the serial port, a power of two
+#define TELEMETRY_BUFFER 128
+
+/* Keep a reading for the next frame, Magnetometer.cpp calls this
+ * @param sample The raw reading
+ * @param heading The heading worked out from it
+ * @param taken halMillis() when the measurement was started
+ */
+void telemetryReading(const MagSample &sample, float heading, unsigned long taken);
+
+/* Queue a frame for the kept reading
+ * @param readMicros Time from the sensor taking the reading to now
+ * @param drawMicros Time spent in compassHead()
+ * @param frame The frame on the LEDs
+ * @return false if there was no reading or no room, the frame is dropped
+ */
+bool telemetrySend(uint16_t readMicros, uint16_t drawMicros, uint8_t frame);
+
+/* Move queued bytes to the serial port without waiting, call this every
+ * time through loop()
+ */
+void telemetryPoll();
+
+#endif
@@ -0,0 +1,74 @@
+#ifndef Twi_H
+#define Twi_H
+
+#include <stdint.h>
+
+/* Interrupt driven I2C master for the ATmega328 TWI, used by HAL_avr.cpp
+ * in place of Wire. A transaction writes a register pointer and any data
+ * after it, then reads after a repeated start if it asks for bytes.
+ * twiQueue() returns at once and the TWI interrupt moves it along a byte
+ * at a time, so loop() keeps running while the bus is busy. Up to
+ * TWI_QUEUE transactions wait their turn, nothing is allocated and the
+ * transactions belong to the caller, who must leave them alone until
+ * their status is no longer TWI_PENDING. A transaction can also name a
+ * function to call when it ends, which runs with interrupts off.
+ *
+ * The interrupt cannot see a stuck bus, twiPoll() gives up on a
+ * transaction once the bus has not moved for the timeout given to
+ * twiBegin(). Anything that keeps the interrupts off, a LED show say,
+ * stops the bus with it, so the timeout has to cover the longest of
+ * those too.
+ */
+
+#define TWI_QUEUE      4
+
+enum TwiStatus {
+  TWI_PENDING,              // Queued or on the bus
+  TWI_DONE,
+  TWI_NACK,                 // Nobody answered at the address, or a byte was refused
+  TWI_ERROR,                // Bus error, lost arbitration or twiEnd()
+  TWI_TIMEOUT               // Took longer than the timeout, see twiPoll()
+};
+
+struct TwiTransaction;
+
+/* Called when a transaction ends, from the TWI interrupt or from the
+ * call that ended it, with interrupts off either way. Keep it short and
+ * do not queue from it
+ */
+typedef void (*TwiDone)(TwiTransaction &t);
+
+struct TwiTransaction {
+  uint8_t address;          // 7 bit
+  uint8_t reg;              // Register pointer, always written first
+  uint8_t writeCount;       // Bytes of data written after reg
+  uint8_t readCount;        // Bytes read into data after the writes
+  uint8_t *data;
+  TwiDone done;             // NULL to just watch status
+  volatile TwiStatus status;
+  unsigned long startUs;    // When it asked for the bus, in micros()
+  unsigned long endUs;      // When it let go of it
+};
+
+/* Take over the TWI pins and start the bus
+ * @param clock SCL in Hz
+ * @param timeout Longest a transaction may hold the bus, in us
+ */
+void twiBegin(unsigned long clock, uint16_t timeout);
+
+/* Let go of the TWI pins, anything queued ends with TWI_ERROR
+ */
+void twiEnd();
+
+/* Queue a transaction, it starts as soon as the ones before it are done
+ * @param t Filled in up to done, status is set here
+ * @return false if the queue is full, t is left alone
+ */
+bool twiQueue(TwiTransaction &t);
+
+/* Time out a transaction that has held the bus too long, call it while
+ * waiting on one. Safe from an interrupt
+ */
+void twiPoll();
+
+#endif
@@ -0,0 +1,26 @@
+#ifndef WarmStart_H
+#define WarmStart_H
+
+/* Warm restart. The hard iron offsets, the needle physics and the last
+ * frame on the LEDs are kept in .noinit RAM, which a reset leaves as it
+ * was, and checked with WARM_MAGIC and a crc8(). After a brownout,
+ * watchdog or reset button the needle is back before the sensor is even
+ * started, and the physics carries on without settling again. At power
+ * on the RAM holds noise that fails the check, so a cold boot takes the
+ * full path. Off the AVR every boot is cold.
+ */
+
+// Change this whenever WarmState in WarmStart.cpp changes
+#define WARM_MAGIC 0x57A2C001UL
+
+/* Put back the state from before the reset, if there is a good one.
+ * Call it after setupLED()
+ * @return true for a warm restart
+ */
+bool warmRestore();
+
+/* Keep the current state for the next reset, call it after each reading
+ */
+void warmSave();
+
+#endif
@@ -0,0 +1,29 @@
+/*--------------------------------------------------------------------
+File:   Arduino stand in for the native build
+
+Doc:  Just enough of Arduino.h for the heading and rendering code to
+      build on the host. There is no flash on the host so PROGMEM is
+      ordinary memory. Time and Serial go through HAL.h, not here.
+--------------------------------------------------------------------*/
+#ifndef NATIVE_ARDUINO_H
+#define NATIVE_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <math.h>
+
+typedef uint8_t byte;
+
+#define PROGMEM
+#define F(text) (text)
+#define pgm_read_byte(addr)  (*(const uint8_t *)(addr))
+#define pgm_read_word(addr)  (*(const uint16_t *)(addr))
+#define pgm_read_dword(addr) (*(const uint32_t *)(addr))
+#define pgm_read_float(addr) (*(const float *)(addr))
+#define memcpy_P memcpy
+
+void setup();
+void loop();
+
+#endif
@@ -0,0 +1,43 @@
+/*--------------------------------------------------------------------
+File:   FastLED stand in for the native build
+
+Doc:  The CRGB pixel type and the colour order names, which is all the
+      rendering code takes from FastLED. Nothing is sent anywhere, the
+      native HAL hands the finished buffer to whoever is watching.
+--------------------------------------------------------------------*/
+#ifndef NATIVE_FASTLED_H
+#define NATIVE_FASTLED_H
+
+#include <Arduino.h>
+
+enum EOrder { RGB = 0012, RBG = 0021, GRB = 0102, GBR = 0120, BRG = 0201, BGR = 0210 };
+
+struct CRGB {
+  uint8_t r;
+  uint8_t g;
+  uint8_t b;
+
+  enum HTMLColorCode {
+    Black = 0x000000,
+    Gray  = 0x808080,
+    Green = 0x008000,
+    Red   = 0xFF0000,
+    Blue  = 0x0000FF,
+    White = 0xFFFFFF
+  };
+
+  CRGB() : r(0), g(0), b(0) {}
+  constexpr CRGB(uint8_t red, uint8_t green, uint8_t blue) : r(red), g(green), b(blue) {}
+  constexpr CRGB(uint32_t code) : r(code >> 16), g(code >> 8), b(code) {}
+  CRGB(HTMLColorCode code) : CRGB((uint32_t)code) {}
+};
+
+inline bool operator==(const CRGB &lhs, const CRGB &rhs){
+  return lhs.r == rhs.r and lhs.g == rhs.g and lhs.b == rhs.b;
+}
+
+inline bool operator!=(const CRGB &lhs, const CRGB &rhs){
+  return !(lhs == rhs);
+}
+
+#endif
@@ -0,0 +1,142 @@
+"""Save the raw magnetometer readings a compass sends, or print a capture.
+
+    python scripts/capture.py record PORT OUT.mcap [--seconds N] [--baud 115200]
+    python scripts/capture.py clean RAW_DUMP OUT.mcap
+    python scripts/capture.py csv IN.mcap
+
+Flash the firmware from [env:capture] first, it sends every reading in
+the format described in include/Capture.h. record reads the serial port
+(needs pyserial, which comes with PlatformIO) until --seconds have gone
+by or Ctrl-C. clean does the same for bytes already saved some other
+way. Both skip the text the firmware prints at start up, drop records
+that fail their sum and write only good ones, so the file is the header
+followed by whole records. csv prints one line per reading with the
+time in ms since power on and the raw counts.
+
+Play a capture back with scripts/replay.py.
+"""
+import argparse
+import struct
+import sys
+import time
+
+MAGIC = b"MCAP"
+VERSION = 1
+SYNC = 0xA5
+RECORD_BYTES = 13
+
+
+class Parser:
+    """Picks header and good records out of a byte stream."""
+
+    def __init__(self):
+        self.buffer = b""
+        self.started = False
+        self.records = []
+        self.dropped = 0
+
+    def feed(self, data):
+        self.buffer += data
+        if not self.started:
+            at = self.buffer.find(MAGIC)
+            if at < 0 or len(self.buffer) < at + len(MAGIC) + 1:
+                self.buffer = self.buffer[-(len(MAGIC) + 1):]
+                return
+            if self.buffer[at + len(MAGIC)] != VERSION:
+                sys.exit("capture version %d, expected %d" % (self.buffer[at + len(MAGIC)], VERSION))
+            self.buffer = self.buffer[at + len(MAGIC) + 1:]
+            self.started = True
+
+        while len(self.buffer) >= RECORD_BYTES:
+            if self.buffer[0] != SYNC:
+                self.buffer = self.buffer[1:]
+                self.dropped += 1
+                continue
+            record = self.buffer[:RECORD_BYTES]
+            if sum(record[1:-1]) & 0xFF != record[-1]:
+                self.buffer = self.buffer[1:]
+                self.dropped += 1
+                continue
+            self.records.append(record)
+            self.buffer = self.buffer[RECORD_BYTES:]
+
+
+def write_capture(path, records):
+    with open(path, "wb") as f:
+        f.write(MAGIC + bytes([VERSION]))
+        for record in records:
+            f.write(record)
+
+
+def decode(record):
+    dt = struct.unpack_from("<H", record, 1)[0]
+    counts = [int.from_bytes(record[3 + 3 * i:6 + 3 * i], "little", signed=True) for i in range(3)]
+    return dt, counts
+
+
+def record_port(args):
+    try:
+        import serial
+    except ImportError:
+        sys.exit("needs pyserial: pip install pyserial")
+    parser = Parser()
+    port = serial.Serial(args.port, args.baud, timeout=0.2)
+    end = time.time() + args.seconds if args.seconds else None
+    try:
+        while end is None or time.time() < end:
+            parser.feed(port.read(256))
+    except KeyboardInterrupt:
+        pass
+    port.close()
+    finish(parser, args.out)
+
+
+def clean(args):
+    parser = Parser()
+    parser.feed(open(args.dump, "rb").read())
+    finish(parser, args.out)
+
+
+def finish(parser, out):
+    if not parser.started:
+        sys.exit("no capture header seen, is the [env:capture] firmware running?")
+    write_capture(out, parser.records)
+    print("%d readings saved to %s, %d bytes dropped" % (len(parser.records), out, parser.dropped))
+
+
+def csv(args):
+    parser = Parser()
+    parser.feed(open(args.capture, "rb").read())
+    if not parser.started:
+        sys.exit("%s is not a capture" % args.capture)
+    print("ms,x,y,z")
+    now = 0
+    for record in parser.records:
+        dt, (x, y, z) = decode(record)
+        now += dt
+        print("%d,%d,%d,%d" % (now, x, y, z))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    commands = parser.add_subparsers(dest="command", required=True)
+    p = commands.add_parser("record")
+    p.add_argument("port")
+    p.add_argument("out")
+    p.add_argument("--seconds", type=float)
+    p.add_argument("--baud", type=int, default=115200)
+    p.set_defaults(run=record_port)
+    p = commands.add_parser("clean")
+    p.add_argument("dump")
+    p.add_argument("out")
+    p.set_defaults(run=clean)
+    p = commands.add_parser("csv")
+    p.add_argument("capture")
+    p.set_defaults(run=csv)
+    args = parser.parse_args()
+    args.run(args)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
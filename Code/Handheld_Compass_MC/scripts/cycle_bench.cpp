@@ -0,0 +1,187 @@
+/*--------------------------------------------------------------------
+File:   Cycle benchmark for the Nano firmware, see scripts/cycle_bench.py
+
+Doc:  Runs the firmware ELF from [env:bench] in simavr as an ATmega328P
+      at 16 MHz. The simulated MMC5603 from MMC5603Sim.h sits on the TWI
+      bus and follows a field script, by default turning 5 degrees a
+      second, about a degree per reading. The BENCH_BEGIN/BENCH_END
+      markers from Bench.h are writes to GPIOR0, and they are timed here
+      in CPU cycles. A JSON report goes to stdout.
+
+      usage: cycle_bench firmware.elf [samples] ["field script"]
+--------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <simavr/sim_avr.h>
+#include <simavr/sim_elf.h>
+#include <simavr/avr_twi.h>
+#include "Bench.h"
+#include "MMC5603Sim.h"
+
+#define CPU_FREQUENCY  16000000UL
+#define GPIOR0_ADDRESS 0x3E       // data space address of GPIOR0
+#define MAX_DEPTH      8
+
+static const char *const sectionNames[] = {
+  "", "loop", "nextMagnetometerData", "compassHead", "updateLED", "ledShow"
+};
+#define NUM_SECTIONS (sizeof(sectionNames) / sizeof(sectionNames[0]))
+
+struct Stats {
+  unsigned long count;
+  uint64_t total;
+  uint64_t min;
+  uint64_t max;
+};
+
+static Stats stats[NUM_SECTIONS];
+static uint8_t openSection[MAX_DEPTH];
+static avr_cycle_count_t openCycle[MAX_DEPTH];
+static uint8_t depth;
+
+/********************************************************
+* Section markers, written to GPIOR0
+********************************************************/
+static void markerWrite(avr_t *avr, avr_io_addr_t addr, uint8_t value, void *param){
+  (void)param;
+  avr->data[addr] = value;
+
+  uint8_t section = value & ~BENCH_END_FLAG;
+  if(section == 0 or section >= NUM_SECTIONS){
+    return;
+  }
+  if(!(value & BENCH_END_FLAG)){
+    if(depth < MAX_DEPTH){
+      openSection[depth] = section;
+      openCycle[depth] = avr->cycle;
+      depth++;
+    }
+    return;
+  }
+
+  // Close the section, and anything left open inside it
+  while(depth > 0){
+    depth--;
+    if(openSection[depth] == section){
+      uint64_t cycles = avr->cycle - openCycle[depth];
+      Stats &s = stats[section];
+      if(s.count == 0 or cycles < s.min){
+        s.min = cycles;
+      }
+      if(cycles > s.max){
+        s.max = cycles;
+      }
+      s.total += cycles;
+      s.count++;
+      break;
+    }
+  }
+}
+
+/********************************************************
+* The simulated MMC5603 on the TWI bus
+********************************************************/
+static avr_irq_t *magIrq;
+
+static void twiAck(uint8_t address, bool ack){
+  if(ack){
+    avr_raise_irq(magIrq + TWI_IRQ_INPUT, avr_twi_irq_msg(TWI_COND_ACK, address, 1));
+  }
+}
+
+static void twiMessage(avr_irq_t *irq, uint32_t value, void *param){
+  (void)irq;
+  avr_t *avr = (avr_t *)param;
+  avr_twi_msg_irq_t msg;
+  msg.u.v = value;
+
+  simMagSetTime(avr->cycle / (CPU_FREQUENCY / 1000));
+  if(msg.u.twi.msg & TWI_COND_STOP){
+    simMagStop();
+  }
+  if(msg.u.twi.msg & TWI_COND_START){
+    twiAck(msg.u.twi.addr, simMagStart(msg.u.twi.addr >> 1, msg.u.twi.addr & 1));
+  }
+  if(msg.u.twi.msg & TWI_COND_WRITE){
+    twiAck(msg.u.twi.addr, simMagWriteByte(msg.u.twi.data));
+  }
+  if(msg.u.twi.msg & TWI_COND_READ){
+    uint8_t data = simMagReadByte();
+    avr_raise_irq(magIrq + TWI_IRQ_INPUT, avr_twi_irq_msg(TWI_COND_READ, msg.u.twi.addr, data));
+  }
+}
+
+static void attachMagnetometer(avr_t *avr){
+  static const char *names[] = {"twi.mmc5603.out", "twi.mmc5603.in"};
+  magIrq = avr_alloc_irq(&avr->irq_pool, 0, 2, names);
+  avr_irq_register_notify(magIrq + TWI_IRQ_OUTPUT, twiMessage, avr);
+  avr_connect_irq(avr_io_getirq(avr, AVR_IOCTL_TWI_GETIRQ(0), TWI_IRQ_OUTPUT), magIrq + TWI_IRQ_OUTPUT);
+  avr_connect_irq(magIrq + TWI_IRQ_INPUT, avr_io_getirq(avr, AVR_IOCTL_TWI_GETIRQ(0), TWI_IRQ_INPUT));
+}
+
+/********************************************************
+* Report
+********************************************************/
+static void report(const char *elf, const char *field, avr_cycle_count_t cycles){
+  printf("{\n  \"elf\": \"%s\",\n  \"frequency\": %lu,\n", elf, CPU_FREQUENCY);
+  printf("  \"samples\": %lu,\n  \"field\": \"%s\",\n", simMagMeasurements(), field);
+  printf("  \"cycles\": %llu,\n  \"sections\": {", (unsigned long long)cycles);
+  const char *comma = "";
+  for(size_t i = 1; i < NUM_SECTIONS; i++){
+    const Stats &s = stats[i];
+    printf("%s\n    \"%s\": {\"count\": %lu, \"min\": %llu, \"avg\": %.1f, \"max\": %llu}",
+           comma, sectionNames[i], s.count, (unsigned long long)s.min,
+           s.count ? (double)s.total / s.count : 0.0, (unsigned long long)s.max);
+    comma = ",";
+  }
+  printf("\n  }\n}\n");
+}
+
+int main(int argc, char **argv){
+  if(argc < 2){
+    fprintf(stderr, "usage: %s firmware.elf [samples] [\"field script\"]\n", argv[0]);
+    return 2;
+  }
+
+  elf_firmware_t firmware = {};
+  if(elf_read_firmware(argv[1], &firmware) != 0){
+    fprintf(stderr, "cannot read %s\n", argv[1]);
+    return 1;
+  }
+
+  avr_t *avr = avr_make_mcu_by_name("atmega328p");
+  if(!avr){
+    fprintf(stderr, "simavr has no atmega328p\n");
+    return 1;
+  }
+  avr_init(avr);
+  avr->frequency = CPU_FREQUENCY;
+  avr_load_firmware(avr, &firmware);
+  avr->log = LOG_ERROR;
+
+  unsigned long samples = argc > 2 ? strtoul(argv[2], NULL, 10) : 360;
+  const char *field = argc > 3 ? argv[3] : "spin=5";
+  if(!simMagConfigure(field)){
+    return 2;
+  }
+  attachMagnetometer(avr);
+  avr_register_io_write(avr, GPIOR0_ADDRESS, markerWrite, NULL);
+
+  // Run until the last sample has been through compassHead()
+  int state = cpu_Running;
+  while(state != cpu_Done and state != cpu_Crashed){
+    state = avr_run(avr);
+    if(simMagMeasurements() > samples){
+      break;
+    }
+  }
+  if(state == cpu_Crashed){
+    fprintf(stderr, "firmware crashed at pc 0x%04x\n", avr->pc);
+    return 1;
+  }
+
+  report(argv[1], field, avr->cycle);
+  return 0;
+}
@@ -0,0 +1,109 @@
+"""Count AVR cycles per section of loop() on a simulated Nano.
+
+    python scripts/cycle_bench.py [--elf FILE] [--samples 360] [--field "spin=5"]
+                                  [--out report.json] [--compare old.json]
+
+Host timings say nothing about an 8 bit CPU doing soft float, so this
+runs the real firmware in simavr instead. Build it first with
+
+    pio run -e bench
+
+which is the folded strip firmware with -DBENCH, so the BENCH_BEGIN and
+BENCH_END markers in Bench.h are live. scripts/cycle_bench.cpp is built
+against libsimavr (found with pkg-config, or set SIMAVR_CFLAGS and
+SIMAVR_LIBS) and runs the ELF for --samples measurements of the
+simulated MMC5603 in src/hal/MMC5603Sim.cpp. --field is its field script,
+see include/MMC5603Sim.h, and by default turns about a degree a reading.
+
+The report is JSON: count, min, avg and max cycles for loop(),
+nextMagnetometerData(), compassHead(), updateLED() and the LED show.
+Sections nest, and compassHead() includes the show it calls. Readings
+are taken by Timer2 and its interrupts, which land in whatever section
+is running, and nextMagnetometerData() counts once per call, so its max
+is the call that works out a heading. --compare prints the change in avg
+and max against an earlier report.
+"""
+import argparse
+import json
+import os
+import shlex
+import subprocess
+import sys
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+import gen_frames  # noqa: E402
+
+PROJECT_DIR = gen_frames.PROJECT_DIR
+HARNESS = os.path.join(PROJECT_DIR, "scripts", "cycle_bench.cpp")
+SIMULATOR = os.path.join(PROJECT_DIR, "src", "hal", "MMC5603Sim.cpp")
+DEFAULT_ELF = os.path.join(PROJECT_DIR, ".pio", "build", "bench", "firmware.elf")
+
+
+def simavr_flags():
+    cflags = os.environ.get("SIMAVR_CFLAGS")
+    libs = os.environ.get("SIMAVR_LIBS")
+    if cflags is None or libs is None:
+        try:
+            cflags = subprocess.run(["pkg-config", "--cflags", "simavr"], capture_output=True,
+                                    text=True, check=True).stdout
+            libs = subprocess.run(["pkg-config", "--libs", "simavr"], capture_output=True,
+                                  text=True, check=True).stdout
+        except (OSError, subprocess.CalledProcessError):
+            cflags, libs = "", "-lsimavr -lelf"
+    return shlex.split(cflags), shlex.split(libs)
+
+
+def build_harness():
+    work = os.path.join(PROJECT_DIR, ".pio", "host", "cycle_bench")
+    program = os.path.join(work, "cycle_bench")
+    sources = [HARNESS, SIMULATOR]
+    if os.path.exists(program) and all(os.path.getmtime(program) >= os.path.getmtime(f) for f in sources):
+        return program
+    os.makedirs(work, exist_ok=True)
+    cflags, libs = simavr_flags()
+    command = ([os.environ.get("CXX", "c++"), "-std=gnu++17", "-O2"] + cflags +
+               ["-I" + os.path.join(PROJECT_DIR, "include"), "-o", program] + sources + libs + ["-lm"])
+    subprocess.run(command, check=True)
+    return program
+
+
+def compare(old, new):
+    print("%-22s %14s %14s %14s %14s" % ("section", "avg before", "avg now", "max before", "max now"))
+    for name, now in new["sections"].items():
+        before = old["sections"].get(name)
+        if not before:
+            continue
+        print("%-22s %14.1f %14.1f %14d %14d" % (name, before["avg"], now["avg"], before["max"], now["max"]))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("--elf", default=DEFAULT_ELF)
+    parser.add_argument("--samples", type=int, default=360)
+    parser.add_argument("--field", default="spin=5")
+    parser.add_argument("--out", help="write the report here as well")
+    parser.add_argument("--compare", help="an earlier report to compare with")
+    args = parser.parse_args()
+
+    if not os.path.exists(args.elf):
+        sys.exit("%s not found, build it with: pio run -e bench" % os.path.relpath(args.elf))
+
+    result = subprocess.run([build_harness(), args.elf, str(args.samples), args.field],
+                            capture_output=True, text=True)
+    if result.returncode:
+        sys.exit(result.stderr.strip() or "cycle_bench failed")
+    report = json.loads(result.stdout)
+
+    if args.out:
+        with open(args.out, "w") as f:
+            json.dump(report, f, indent=2)
+            f.write("\n")
+    if args.compare:
+        compare(json.load(open(args.compare)), report)
+    else:
+        print(json.dumps(report, indent=2))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
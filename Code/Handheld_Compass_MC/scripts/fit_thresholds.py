@@ -0,0 +1,234 @@
+"""Work out frame boundaries from the geometry instead of by hand.
+
+    python scripts/fit_thresholds.py [--step 0.2] [--min-width 1.0]
+                                     [--max-width 15.0] [--evenness 1.0]
+                                     [--out frames/needle_frames_fitted.txt]
+
+For every needle angle, in --step degree steps, an ideal needle is drawn
+over the LED positions from include/Layout.h the same way the rasterizer
+draws it: red along the needle, a gray tail and a gray cross guard, each
+LED fading out one LED pitch from the line. Every frame in
+frames/needle_frames.txt is scored by how far its lit LEDs are from that
+picture. The frames are kept in their clockwise order and each gets one
+unbroken range of angles between --min-width and --max-width wide. A
+dynamic program picks the ranges with the smallest total mismatch plus
+--evenness times the squared distance of each width from an even share
+of the dial, so badly matching in-between frames do not collapse into
+slivers again.
+
+The result is written as a copy of the frame file with new ranges, ready
+for gen_frames.py (set custom_needle_frames in platformio.ini to use it).
+Per-bin width statistics for the measured and the fitted ranges are
+printed and kept in the header of the output.
+"""
+import argparse
+import math
+import os
+import re
+import statistics
+import sys
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+import gen_frames  # noqa: E402
+
+TAIL_LENGTH = 2.0
+GUARD_LENGTH = 1.25
+GRAY_WEIGHT = 0.5   # a wrong gray LED matters less than a wrong red one
+
+
+def coverage(distance):
+    return max(0.0, 1.0 - abs(distance))
+
+
+def ideal_needle(angle, positions):
+    """Red and gray intensity of every LED for a needle at angle degrees."""
+    a = math.radians(angle)
+    ux, uy = math.sin(a), math.cos(a)
+    red, gray = {}, {}
+    for led, (dx, dy) in positions.items():
+        along = dx * ux + dy * uy
+        across = dx * uy - dy * ux
+        r = g = 0.0
+        if dx == 0 and dy == 0:
+            r = 1.0
+        elif along > 0:
+            r = coverage(across)
+        elif -along <= TAIL_LENGTH:
+            g = coverage(across)
+        if (dx or dy) and abs(across) <= GUARD_LENGTH:
+            g = max(g, coverage(along))
+        if r >= g:
+            red[led] = r
+        else:
+            gray[led] = g
+    return red, gray
+
+
+def mismatch(frame, red, gray, leds):
+    cost = 0.0
+    for led in leds:
+        cost += abs(red.get(led, 0.0) - (1.0 if frame["red"] >> led & 1 else 0.0))
+        cost += GRAY_WEIGHT * abs(gray.get(led, 0.0) - (1.0 if frame["gray"] >> led & 1 else 0.0))
+    return cost
+
+
+def measured_ranges(settings, frames):
+    """Needle angle (360 - heading) range of every frame as measured."""
+    east = [f for f in frames if f["half"] == "east"]
+    west = [f for f in frames if f["half"] == "west"]
+    ranges = []
+    lower = float(settings["east-wrap"]) - 360.0   # north wraps past 0
+    for f in east:
+        ranges.append((lower, float(f["upper"])))
+        lower = float(f["upper"])
+    ends = [360.0 - float(f["upper"]) for f in west[1:]] + [360.0 - float(settings["west-lower"])]
+    for f, end in zip(west, ends):
+        ranges.append((360.0 - float(f["upper"]), end))
+    return ranges
+
+
+def fit(frames, positions, step, min_width, max_width, evenness):
+    samples = int(round(360.0 / step))
+    leds = list(positions)
+    # Frame order around the dial, with north again at the end for the wrap
+    order = list(range(len(frames))) + [0]
+    k_count = len(order)
+    min_len = max(1, int(round(min_width / step)))
+    max_len = max(min_len, int(round(max_width / step)))
+    if k_count * min_len > samples or (k_count - 1) * max_len < samples:
+        sys.exit("fit_thresholds: no way to fit %d frames between --min-width and --max-width"
+                 % len(frames))
+
+    # prefix[k][i] is the mismatch of frame order[k] over samples [0, i),
+    # in mismatch x degrees so it does not depend on --step
+    pictures = [ideal_needle(i * step, positions) for i in range(samples)]
+    prefix = []
+    for f in (frames[k] for k in order):
+        p = [0.0]
+        for red, gray in pictures:
+            p.append(p[-1] + mismatch(f, red, gray, leds) * step)
+        prefix.append(p)
+
+    # Penalty for a bin of n samples drifting from an even share of the dial.
+    # North appears twice, so it is judged on its two pieces together below.
+    even = 360.0 / len(frames)
+    spread = [evenness * (n * step - even) ** 2 for n in range(max_len + 1)]
+
+    inf = float("inf")
+    best = [[inf] * (samples + 1) for _ in range(k_count)]
+    back = [[0] * (samples + 1) for _ in range(k_count)]
+    for i in range(min_len, max_len + 1):
+        best[0][i] = prefix[0][i]
+    for k in range(1, k_count):
+        prev, row, link, p = best[k - 1], best[k], back[k], prefix[k]
+        last = k == k_count - 1
+        for i in range(min_len, samples + 1):
+            if last and i != samples:
+                continue
+            for j in range(max(0, i - max_len), i - min_len + 1):
+                if prev[j] == inf:
+                    continue
+                cost = prev[j] + p[i] - p[j]
+                if last:
+                    north = (i - j) + _first_len(back, j, k - 1)
+                    cost += evenness * (north * step - even) ** 2
+                else:
+                    cost += spread[i - j]
+                if cost < row[i]:
+                    row[i] = cost
+                    link[i] = j
+
+    ends = [samples]
+    for k in range(k_count - 1, 0, -1):
+        ends.append(back[k][ends[-1]])
+    ends.reverse()   # ends[k] is where segment k stops, in samples
+    return [e * step for e in ends], best[k_count - 1][samples]
+
+
+def _first_len(back, i, k):
+    """Length of the first segment on the best path ending at segment k, sample i."""
+    while k > 0:
+        i = back[k][i]
+        k -= 1
+    return i
+
+
+def width_stats(widths):
+    return "min %.1f  max %.1f  mean %.2f  stdev %.2f  under 1 degree %d" % (
+        min(widths), max(widths), statistics.mean(widths), statistics.pstdev(widths),
+        sum(1 for w in widths if w < 1.0))
+
+
+def write_frames(src, dst, frames, settings, stats):
+    lines = open(src).read().splitlines()
+    n = 0
+    out = ["# Fitted by scripts/fit_thresholds.py from %s" % os.path.relpath(src, gen_frames.PROJECT_DIR)]
+    out += ["#   %s" % s for s in stats]
+    for line in lines:
+        words = line.split("#", 1)[0].split()
+        if words and words[0] in ("east-wrap", "west-lower"):
+            line = "%s %s" % (words[0], settings[words[0]])
+        elif words and words[0] == "frame":
+            line = re.sub(r"^(frame\s+\S+\s+\S+\s+)\S+", r"\g<1>" + frames[n]["upper"], line)
+            n += 1
+        out.append(line)
+    with open(dst, "w") as f:
+        f.write("\n".join(out) + "\n")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("--frames", default=gen_frames.FRAME_FILE)
+    parser.add_argument("--layout", default=gen_frames.LAYOUT_FILE)
+    parser.add_argument("--step", type=float, default=0.2)
+    parser.add_argument("--min-width", type=float, default=1.0)
+    parser.add_argument("--max-width", type=float, default=15.0)
+    parser.add_argument("--evenness", type=float, default=1.0,
+                        help="weight pulling every bin toward 360 / frames degrees")
+    parser.add_argument("--out", default=os.path.join(gen_frames.PROJECT_DIR, "frames",
+                                                      "needle_frames_fitted.txt"))
+    args = parser.parse_args()
+
+    text = open(args.layout).read()
+    cx = int(re.search(r"#define LAYOUT_CENTER_X\s+(\d+)", text).group(1))
+    cy = int(re.search(r"#define LAYOUT_CENTER_Y\s+(\d+)", text).group(1))
+    grid, width, height = gen_frames.read_layout(args.layout)
+    positions = {led: (x - cx, cy - y) for (x, y), led in grid.items()}
+
+    settings, frames = gen_frames.parse_frames(args.frames, grid, width, height)
+    east, west = gen_frames.check_order(frames)
+
+    before = [hi - lo for lo, hi in measured_ranges(settings, frames)]
+    ends, cost = fit(frames, positions, args.step, args.min_width, args.max_width, args.evenness)
+
+    # Segment k runs from ends[k - 1] to ends[k]; the last is north again
+    fitted = dict(settings)
+    fitted["east-wrap"] = "%.1f" % ends[-2]
+    # Half a step lower so a heading of exactly (360 - east-wrap) is not left
+    # between the halves; the east half is checked first, so nothing overlaps
+    fitted["west-lower"] = "%.2f" % (360.0 - ends[-2] - args.step / 2)
+    new_frames = []
+    for n, f in enumerate(frames):
+        f = dict(f)
+        if f["half"] == "east":
+            f["upper"] = "%.1f" % ends[n]
+        else:
+            f["upper"] = "%.1f" % (360.0 - ends[n - 1])
+        new_frames.append(f)
+    after = [ends[0] + 360.0 - ends[-2]] + [ends[n] - ends[n - 1] for n in range(1, len(frames))]
+
+    stats = ["measured bin widths: " + width_stats(before),
+             "fitted bin widths:   " + width_stats(after),
+             "total cost %.1f, step %.2f, evenness %.2f" % (cost, args.step, args.evenness)]
+    for s in stats:
+        print(s)
+    print("%-10s %10s %10s" % ("frame", "measured", "fitted"))
+    for f, b, a in zip(frames, before, after):
+        print("%-10s %10.1f %10.1f" % (f["name"], b, a))
+
+    write_frames(args.frames, args.out, new_frames, fitted, stats)
+    print("wrote %s" % os.path.relpath(args.out))
+
+
+if __name__ == "__main__":
+    main()
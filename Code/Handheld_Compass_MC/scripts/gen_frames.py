@@ -0,0 +1,226 @@
+"""Build the needle frame table from frames/needle_frames.txt.
+
+Run by PlatformIO before every build (extra_scripts = pre:...). Writes
+FrameTable.h (counts) and FrameTable.inc (PROGMEM data, included by
+src/Frames.cpp) into $BUILD_DIR/generated and adds that to the include
+path. Can also be run by hand:
+
+    python scripts/gen_frames.py [output_dir] [frame_file]
+
+The frame file holds, in order clockwise from north:
+
+    east-wrap 349.0        (360 - heading) above this is still north
+    west-lower 11.6        heading must be above this for a west frame
+
+    frame <name> east <upper> [north|south]
+    <5 diagram rows>
+
+    frame <name> west <upper>
+    <5 diagram rows>
+
+East frames are chosen by (360 - heading) <= upper, west frames by
+heading <= upper. Diagram rows are drawn on the 11 x 5 grid from
+include/Layout.h: R red, G gray, x off, X or space where there is no LED.
+"""
+import os
+import re
+import sys
+
+PROJECT_DIR = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+FRAME_FILE = os.path.join(PROJECT_DIR, "frames", "needle_frames.txt")
+LAYOUT_FILE = os.path.join(PROJECT_DIR, "include", "Layout.h")
+
+COLORS = {"R": "red", "G": "gray", "x": None}
+
+
+class FrameError(Exception):
+    pass
+
+
+def read_layout(path=LAYOUT_FILE):
+    """Return {(x, y): led} from the layoutRows table in Layout.h."""
+    text = open(path).read()
+    width = int(re.search(r"#define LAYOUT_WIDTH\s+(\d+)", text).group(1))
+    height = int(re.search(r"#define LAYOUT_HEIGHT\s+(\d+)", text).group(1))
+    block = re.search(r"layoutRows\[LAYOUT_HEIGHT\]\s*=\s*\{(.*?)\};", text, re.S).group(1)
+    rows = re.findall(r"\{\s*(\d+),\s*(\d+),\s*(true|false)\s*\}", block)
+    if len(rows) != height:
+        raise FrameError("Layout.h: expected %d rows, found %d" % (height, len(rows)))
+
+    grid = {}
+    led = 0
+    for r, (count, left, right_to_left) in enumerate(rows):
+        count, left = int(count), int(left)
+        y = height - 1 - r
+        for n in range(count):
+            x = left + count - 1 - n if right_to_left == "true" else left + n
+            grid[(x, y)] = led
+            led += 1
+    return grid, width, height
+
+
+def parse_frames(path, grid, width, height):
+    lines = open(path).read().splitlines()
+    settings = {}
+    frames = []
+    i = 0
+    while i < len(lines):
+        line = lines[i].split("#", 1)[0].rstrip()
+        i += 1
+        if not line.strip():
+            continue
+        words = line.split()
+        if words[0] in ("east-wrap", "west-lower"):
+            settings[words[0]] = words[1]
+            continue
+        if words[0] != "frame" or len(words) not in (4, 5) or words[2] not in ("east", "west"):
+            raise FrameError("%s:%d: expected 'frame <name> east|west <upper>'" % (path, i))
+
+        frame = {"name": words[1], "half": words[2], "upper": words[3],
+                 "tag": words[4] if len(words) == 5 else None,
+                 "red": 0, "gray": 0, "line": i}
+        float(frame["upper"])
+
+        for y in range(height):
+            if i >= len(lines):
+                raise FrameError("%s: frame %s is missing diagram rows" % (path, frame["name"]))
+            row = lines[i].ljust(width)
+            i += 1
+            for x in range(width):
+                c = row[x]
+                led = grid.get((x, y))
+                if c in COLORS:
+                    if led is None:
+                        raise FrameError("%s:%d: '%s' where there is no LED" % (path, i, c))
+                    if COLORS[c]:
+                        frame[COLORS[c]] |= 1 << led
+                elif c in "X ":
+                    if led is not None:
+                        raise FrameError("%s:%d: LED %d has no color" % (path, i, led))
+                else:
+                    raise FrameError("%s:%d: unknown pixel '%s'" % (path, i, c))
+        frames.append(frame)
+
+    for key in ("east-wrap", "west-lower"):
+        if key not in settings:
+            raise FrameError("%s: missing %s" % (path, key))
+    return settings, frames
+
+
+def check_order(frames):
+    east = [f for f in frames if f["half"] == "east"]
+    west = [f for f in frames if f["half"] == "west"]
+    if frames[:len(east)] != east:
+        raise FrameError("east frames must come first, clockwise from north")
+    for a, b in zip(east, east[1:]):
+        if float(b["upper"]) <= float(a["upper"]):
+            raise FrameError("east frame %s must end after %s" % (b["name"], a["name"]))
+    for a, b in zip(west, west[1:]):
+        if float(b["upper"]) >= float(a["upper"]):
+            raise FrameError("west frame %s must end before %s" % (b["name"], a["name"]))
+    for tag in ("north", "south"):
+        if [f["tag"] for f in frames].count(tag) != 1:
+            raise FrameError("exactly one frame must be tagged %s" % tag)
+    if east[0]["tag"] != "north" or east[-1]["tag"] != "south":
+        raise FrameError("east frames must run from north to south")
+    return east, west
+
+
+def float_literal(text):
+    return (text if "." in text else text + ".0") + "f"
+
+
+def float_table(values):
+    values = [float_literal(v) for v in values]
+    return ",\n".join("  " + ", ".join(values[i:i + 8]) for i in range(0, len(values), 8))
+
+
+def frame_centres(settings, east, west):
+    """Where each frame's needle points, as a binary angle clockwise from
+    the top (65536 a turn): the middle of its range of (360 - heading)."""
+    centres = []
+    lower = float(settings["east-wrap"]) - 360
+    for f in east:
+        upper = float(f["upper"])
+        centres.append((lower + upper) / 2)
+        lower = upper
+    # West frames run clockwise, so each range ends where the next begins
+    lowers = [float(f["upper"]) for f in west[1:]] + [float(settings["west-lower"])]
+    for f, lower in zip(west, lowers):
+        centres.append(360 - (lower + float(f["upper"])) / 2)
+    return [int(round(c * 65536 / 360)) % 65536 for c in centres]
+
+
+def generate(out_dir, frame_file=FRAME_FILE, layout_file=LAYOUT_FILE):
+    grid, width, height = read_layout(layout_file)
+    settings, frames = parse_frames(frame_file, grid, width, height)
+    east, west = check_order(frames)
+    centres = frame_centres(settings, east, west)
+
+    header = [
+        "// Generated by scripts/gen_frames.py from %s, do not edit" % os.path.relpath(frame_file, PROJECT_DIR),
+        "#ifndef FrameTable_H",
+        "#define FrameTable_H",
+        "",
+        "#define NUM_FRAMES  %d" % len(frames),
+        "#define FRAME_NORTH %d" % [f["tag"] for f in frames].index("north"),
+        "#define FRAME_SOUTH %d" % [f["tag"] for f in frames].index("south"),
+        "#define EAST_RANGES %d" % len(east),
+        "#define WEST_RANGES %d" % len(west),
+        "#define EAST_WRAP   %s" % float_literal(settings["east-wrap"]),
+        "#define WEST_LOWER  %s" % float_literal(settings["west-lower"]),
+        "",
+        "#endif",
+        "",
+    ]
+
+    source = os.path.relpath(frame_file, PROJECT_DIR)
+    data = ["// Generated by scripts/gen_frames.py from %s, do not edit" % source,
+            "static const NeedleFrame frames[NUM_FRAMES] PROGMEM = {"]
+    for n, f in enumerate(frames):
+        data.append("  FRAME(0x%012XULL, 0x%012XULL),  // %d %s" % (f["red"], f["gray"], n, f["name"]))
+    data += ["};", "",
+             "static const float eastUpper[EAST_RANGES] PROGMEM = {",
+             float_table([f["upper"] for f in east]), "};", "",
+             "static const float westUpper[WEST_RANGES] PROGMEM = {",
+             float_table([f["upper"] for f in reversed(west)]), "};", "",
+             "static const uint16_t frameCentre[NUM_FRAMES] PROGMEM = {",
+             ",\n".join("  " + ", ".join("%5d" % c for c in centres[i:i + 8])
+                        for i in range(0, len(centres), 8)), "};", ""]
+
+    os.makedirs(out_dir, exist_ok=True)
+    write_if_changed(os.path.join(out_dir, "FrameTable.h"), "\n".join(header))
+    write_if_changed(os.path.join(out_dir, "FrameTable.inc"), "\n".join(data))
+
+
+def write_if_changed(path, text):
+    # Leave the file alone when nothing changed so it does not force a rebuild
+    if os.path.exists(path) and open(path).read() == text:
+        return
+    with open(path, "w") as f:
+        f.write(text)
+
+
+try:
+    Import("env")  # noqa: F821, only defined inside PlatformIO
+except NameError:
+    env = None
+
+if env is not None:
+    out = os.path.join(env.subst("$BUILD_DIR"), "generated")
+    # custom_needle_frames in platformio.ini picks another frame file,
+    # e.g. one written by fit_thresholds.py
+    frame_file = env.GetProjectOption("custom_needle_frames", "")
+    frame_file = os.path.join(PROJECT_DIR, frame_file) if frame_file else FRAME_FILE
+    try:
+        generate(out, frame_file)
+    except FrameError as e:
+        sys.stderr.write("gen_frames: %s\n" % e)
+        env.Exit(1)
+    env.Append(CPPPATH=[out])
+elif __name__ == "__main__":
+    try:
+        generate(sys.argv[1] if len(sys.argv) > 1 else os.path.join(PROJECT_DIR, ".pio", "generated"),
+                 sys.argv[2] if len(sys.argv) > 2 else FRAME_FILE)
+    except FrameError as e:
+        sys.exit("gen_frames: %s" % e)
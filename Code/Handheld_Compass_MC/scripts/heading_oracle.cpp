@@ -0,0 +1,53 @@
+/*--------------------------------------------------------------------
+File:   compassHead() probe for scripts/heading_oracle.py
+
+Doc:  Built on the host against the native HAL. Reads headings from
+      stdin, one per line as the hex bits of a float, and for each one
+      prints the LEDs that compassHead() showed in layout order, see the
+      LED array in LED.cpp, or - if it never called show. Every heading
+      starts from a cleared needle, so the answer does not depend on the
+      heading before it.
+--------------------------------------------------------------------*/
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "NativeHAL.h"
+#include "LED.h"
+
+static char shown[NUM_LEDS + 1];
+static bool wasShown;
+
+/******************************************************** 
+* Keep whatever was sent to the LEDs, in layout order, which is
+* the same for every board
+********************************************************/
+static void capture(const CRGB *leds, uint8_t count, unsigned long now){
+  (void)now;
+  char line[NUM_LEDS + 1];
+  halNativeLedText(leds, count, line);
+  for(uint8_t i = 0; i < NUM_LEDS; i++){
+    shown[i] = line[boardLed(i)];
+  }
+  shown[NUM_LEDS] = '\0';
+  wasShown = true;
+}
+
+int main(){
+  setupLED();
+  setNeedleMode(NEEDLE_SNAP);
+  halNativeOnShow(capture);
+
+  unsigned long bits;
+  while(scanf("%lx", &bits) == 1){
+    uint32_t raw = bits;
+    float heading;
+    memcpy(&heading, &raw, sizeof(heading));
+
+    // NaN lands in no range, which clears the needle
+    compassHead(NAN);
+    wasShown = false;
+    compassHead(heading);
+    puts(wasShown ? shown : "-");
+  }
+  return 0;
+}
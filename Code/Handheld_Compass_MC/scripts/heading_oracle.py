@@ -0,0 +1,158 @@
+"""Record what compassHead() shows for every heading, for the oracle test.
+
+    python scripts/heading_oracle.py --record [--force] [--frames FILE]
+                                     [--golden test/test_heading_oracle/golden.h]
+
+The LED code is built for the host by scripts/host_build.py with
+scripts/heading_oracle.cpp as the driver, then asked for every heading
+from 0 to 360 in 0.01 degree steps, the float values either side of
+every frame boundary, NaN, the infinities, negative headings and
+headings of 360 or more. The LEDs shown for each heading, in layout
+order, are written to the golden table, which test/test_heading_oracle
+checks the current code against with pio test -e native.
+
+--record writes what the code in the tree shows now, whatever that is.
+The table in the repo is not that: it was recorded from the original
+if/else chain in compassHead(), built with float constants the way the
+AVR compiler sees them, before the frame tables replaced it. It is the
+reference any rewrite has to match, so an existing table is only
+overwritten with --force, when the needle is meant to change and the
+new table has been checked by hand.
+"""
+import argparse
+import math
+import os
+import struct
+import subprocess
+import sys
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+import gen_frames  # noqa: E402
+import host_build  # noqa: E402
+
+PROJECT_DIR = gen_frames.PROJECT_DIR
+GOLDEN_FILE = os.path.join(PROJECT_DIR, "test", "test_heading_oracle", "golden.h")
+PROBE = os.path.join(PROJECT_DIR, "scripts", "heading_oracle.cpp")
+EDGE_ULPS = 4       # floats checked either side of every boundary
+SPECIALS = [-0.01, -1.0, -90.0, -180.0, -359.99, -360.0, -720.0, -1e6, -3.4e38,
+            360.0, 360.01, 361.0, 400.0, 540.0, 720.0, 1e6, 3.4e38,
+            float("inf"), float("-inf")]
+LAST = [-0.0, float("nan")]  # kept out of the sorted part, -0.0 == 0.0 and NaN has no place
+
+
+def f32(value):
+    return struct.unpack("<f", struct.pack("<f", value))[0]
+
+
+def f32_bits(value):
+    return struct.unpack("<I", struct.pack("<f", value))[0]
+
+
+def f32_step(value, steps):
+    """The float steps floats above value, or below for negative steps."""
+    bits = f32_bits(value)
+    # floats order like sign-magnitude integers
+    key = bits if bits < 0x80000000 else -(bits & 0x7FFFFFFF)
+    key += steps
+    bits = key if key >= 0 else (-key) | 0x80000000
+    return struct.unpack("<f", struct.pack("<I", bits))[0]
+
+
+def read_ranges(frame_file):
+    grid, width, height = gen_frames.read_layout()
+    settings, frames = gen_frames.parse_frames(frame_file, grid, width, height)
+    east, west = gen_frames.check_order(frames)
+    return (f32(float(settings["east-wrap"])), f32(float(settings["west-lower"])),
+            [f32(float(f["upper"])) for f in east], [f32(float(f["upper"])) for f in west])
+
+
+def headings(ranges):
+    wrap, lower, east, west = ranges
+    values = {f32(i / 100.0) for i in range(0, 36001)}
+    # east boundaries are on 360 - heading, west ones on the heading
+    edges = [f32(360.0 - u) for u in east + [wrap]] + west + [lower, 0.0, 360.0]
+    for edge in edges:
+        values.update(f32_step(edge, s) for s in range(-EDGE_ULPS, EDGE_ULPS + 1))
+    values.update(f32(v) for v in SPECIALS)
+    values.discard(0.0)
+    return sorted(values | {0.0}) + LAST
+
+
+def probe(program, values):
+    text = "".join("%08x\n" % f32_bits(v) for v in values)
+    result = subprocess.run([program], input=text, capture_output=True, text=True, check=True)
+    lines = result.stdout.split()
+    if len(lines) != len(values):
+        sys.exit("probe answered %d of %d headings" % (len(lines), len(values)))
+    return lines
+
+
+def heading_text(value):
+    return "%.9g" % value
+
+
+def c_float(value):
+    """value as a C float literal that reads back as the same float."""
+    if math.isinf(value):
+        return "-INFINITY" if value < 0 else "INFINITY"
+    text = heading_text(value)
+    return (text if "." in text or "e" in text else text + ".0") + "f"
+
+
+def write_golden(path, values, lines):
+    out = ["// compassHead() golden table, written by scripts/heading_oracle.py --record",
+           "// and checked by test_main.cpp. Each run is the first and last heading",
+           "// of a stretch that shows the same LEDs in layout order, see the LED",
+           "// array in LED.cpp: R red, G gray, . off, - nothing shown",
+           "#ifndef Golden_H",
+           "#define Golden_H",
+           "",
+           "#include <math.h>",
+           "",
+           "struct GoldenRun {",
+           "  float first;",
+           "  float last;",
+           "  const char *leds;",
+           "};",
+           "",
+           "static const GoldenRun goldenRuns[] = {"]
+    ordered = len(values) - len(LAST)
+    i = 0
+    while i < ordered:
+        j = i
+        while j + 1 < ordered and lines[j + 1] == lines[i]:
+            j += 1
+        out.append('  {%s, %s, "%s"},' % (c_float(values[i]), c_float(values[j]), lines[i]))
+        i = j + 1
+    out += ["};", ""]
+    # -0.0 == 0.0 and NaN is not ordered, so they get their own entries
+    for name, leds in zip(("goldenNegativeZero", "goldenNaN"), lines[ordered:]):
+        out.append('static const char %s[] = "%s";' % (name, leds))
+    out += ["", "#endif", ""]
+    with open(path, "w") as f:
+        f.write("\n".join(out))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("--frames", default=gen_frames.FRAME_FILE)
+    parser.add_argument("--golden", default=GOLDEN_FILE)
+    parser.add_argument("--record", action="store_true", help="write the golden table from the current code")
+    parser.add_argument("--force", action="store_true", help="overwrite an existing golden table")
+    args = parser.parse_args()
+
+    if not args.record:
+        sys.exit("the check runs with pio test -e native, pass --record to write the golden table")
+    if os.path.exists(args.golden) and not args.force:
+        sys.exit("%s is the reference the code is checked against, pass --force to replace it "
+                 "with what the current code shows" % os.path.relpath(args.golden))
+
+    values = headings(read_ranges(args.frames))
+    lines = probe(host_build.build(PROBE, args.frames), values)
+    write_golden(args.golden, values, lines)
+    print("recorded %d headings to %s" % (len(values), os.path.relpath(args.golden)))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
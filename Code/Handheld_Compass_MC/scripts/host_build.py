@@ -0,0 +1,57 @@
+"""Build a host program around the LED code, for the tools in scripts/.
+
+    program = host_build.build("scripts/snapshot.cpp")
+
+Everything in src/ is compiled for the build machine the way [env:native]
+in platformio.ini does it, against the native HAL and a frame table
+generated from frame_file, and linked with the given driver, which
+brings its own main(). The program is kept in .pio/host/<driver name>
+and only built again when a source, a header or the frame file changes.
+"""
+import glob
+import os
+import subprocess
+
+import gen_frames
+
+PROJECT_DIR = gen_frames.PROJECT_DIR
+
+
+def sources(driver):
+    found = sorted(glob.glob(os.path.join(PROJECT_DIR, "src", "*.cpp")))
+    hal = os.path.join(PROJECT_DIR, "src", "hal")
+    return found + [os.path.join(hal, "HAL_native.cpp"), os.path.join(hal, "MMC5603Sim.cpp"), driver]
+
+
+def up_to_date(program, stamp, inputs, frame_file):
+    if not os.path.exists(program) or not os.path.exists(stamp):
+        return False
+    if open(stamp).read() != os.path.abspath(frame_file):
+        return False
+    built = os.path.getmtime(program)
+    return all(os.path.getmtime(path) <= built for path in inputs)
+
+
+def build(driver, frame_file=gen_frames.FRAME_FILE):
+    name = os.path.splitext(os.path.basename(driver))[0]
+    work = os.path.join(PROJECT_DIR, ".pio", "host", name)
+    program = os.path.join(work, name)
+    stamp = os.path.join(work, "frame_file")
+
+    files = sources(driver)
+    headers = (glob.glob(os.path.join(PROJECT_DIR, "include", "*.h")) +
+               glob.glob(os.path.join(PROJECT_DIR, "native", "include", "*.h")))
+    if up_to_date(program, stamp, files + headers + [frame_file], frame_file):
+        return program
+
+    gen_frames.generate(os.path.join(work, "generated"), frame_file)
+    command = [os.environ.get("CXX", "c++"), "-std=gnu++17", "-O2",
+               "-DHAL_NATIVE", "-DBOARD_FOLDED_STRIP",
+               "-I" + os.path.join(PROJECT_DIR, "native", "include"),
+               "-I" + os.path.join(PROJECT_DIR, "include"),
+               "-I" + os.path.join(work, "generated"),
+               "-o", program] + files + ["-lm"]
+    subprocess.run(command, check=True)
+    with open(stamp, "w") as f:
+        f.write(os.path.abspath(frame_file))
+    return program
@@ -0,0 +1,246 @@
+/*--------------------------------------------------------------------
+File:   Capture replay for scripts/replay.py
+
+Doc:  Runs setup() and loop() on the native HAL with the readings from a
+      capture (see Capture.h) in place of the magnetometer, so they go
+      through Magnetometer.cpp and compassHead() exactly as on the
+      compass. The clock is virtual and moves 1 ms per loop(), so a
+      replay takes as long as the CPU needs and gives the same answer
+      every time. Each reading is held back until the clock reaches the
+      time it was recorded at, and the one before it is read again
+      meanwhile, so the spacing and gaps of the capture come through.
+
+      One CSV line per reading goes to stdout, the summary to stderr,
+      with the latency histograms from Latency.h.
+      usage: replay capture.mcap [snap|animated|physical|raster] [tail ms]
+--------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <vector>
+#include "NativeHAL.h"
+#include "Capture.h"
+#include "LED.h"
+#include "Latency.h"
+
+struct Reading {
+  unsigned long recorded;   // ms since power on, from the capture
+  MagSample sample;
+  unsigned long read;       // when Magnetometer.cpp took it
+  long firstShow;           // first show after it, -1 for none
+  char leds[NUM_LEDS + 1];  // last picture shown before the next reading
+};
+
+static std::vector<Reading> readings;
+static size_t next;
+static unsigned long shows;
+static uint64_t digest = 14695981039346656037ULL;
+
+/********************************************************
+* FNV-1a over everything that was shown and when
+********************************************************/
+static void hash(const void *data, size_t length){
+  const uint8_t *p = (const uint8_t *)data;
+  for(size_t i = 0; i < length; i++){
+    digest = (digest ^ p[i]) * 1099511628211ULL;
+  }
+}
+
+static int32_t get24(const uint8_t *p){
+  int32_t value = p[0] | ((int32_t)p[1] << 8) | ((int32_t)p[2] << 16);
+  return value & 0x800000 ? value - 0x1000000 : value;
+}
+
+/********************************************************
+* Read the capture, skipping anything that fails its sum
+********************************************************/
+static bool load(const char *path){
+  FILE *in = fopen(path, "rb");
+  if(!in){
+    perror(path);
+    return false;
+  }
+  std::vector<uint8_t> data;
+  uint8_t buffer[4096];
+  size_t got;
+  while((got = fread(buffer, 1, sizeof(buffer), in)) > 0){
+    data.insert(data.end(), buffer, buffer + got);
+  }
+  fclose(in);
+
+  size_t header = strlen(CAPTURE_MAGIC) + 1;
+  if(data.size() < header or memcmp(data.data(), CAPTURE_MAGIC, header - 1) != 0 or
+     data[header - 1] != CAPTURE_VERSION){
+    fprintf(stderr, "%s is not a version %d capture\n", path, CAPTURE_VERSION);
+    return false;
+  }
+
+  unsigned long now = 0;
+  for(size_t i = header; i + CAPTURE_RECORD_BYTES <= data.size(); ){
+    const uint8_t *r = &data[i];
+    uint8_t sum = 0;
+    for(uint8_t k = 1; k < CAPTURE_RECORD_BYTES - 1; k++){
+      sum += r[k];
+    }
+    if(r[0] != CAPTURE_SYNC or sum != r[CAPTURE_RECORD_BYTES - 1]){
+      i++;
+      continue;
+    }
+    Reading reading = {};
+    now += r[1] | (r[2] << 8);
+    reading.recorded = now;
+    reading.sample.x = get24(&r[3]);
+    reading.sample.y = get24(&r[6]);
+    reading.sample.z = get24(&r[9]);
+    reading.firstShow = -1;
+    readings.push_back(reading);
+    i += CAPTURE_RECORD_BYTES;
+  }
+  return true;
+}
+
+/********************************************************
+* The magnetometer, one captured reading per read
+********************************************************/
+static bool replaySource(unsigned long now, MagSample &out){
+  // Hold the last reading through the tail, a failed read would start
+  // the search for a missing sensor
+  if(readings.empty()){
+    return false;
+  }
+  if(next >= readings.size()){
+    out = readings.back().sample;
+    return true;
+  }
+
+  // Not recorded yet, the sensor would still give the one before
+  if(next > 0 and now < readings[next].recorded){
+    out = readings[next - 1].sample;
+    return true;
+  }
+  Reading &r = readings[next];
+  if(next > 0){
+    // The picture left up by the previous reading
+    strcpy(r.leds, readings[next - 1].leds);
+  }else{
+    memset(r.leds, '.', NUM_LEDS);
+  }
+  r.read = now;
+  out = r.sample;
+  next++;
+  return true;
+}
+
+static void showHook(const CRGB *leds, uint8_t count, unsigned long now){
+  shows++;
+  hash(&now, sizeof(now));
+  hash(leds, count * sizeof(CRGB));
+  if(next == 0){
+    return;
+  }
+  Reading &r = readings[next - 1];
+  if(r.firstShow < 0){
+    r.firstShow = now;
+  }
+  halNativeLedText(leds, count, r.leds);
+}
+
+/********************************************************
+* The histograms from Latency.h, with their median and 99th percentile
+********************************************************/
+static void printHistograms(){
+  static const char *const names[LATENCY_HISTOGRAMS] = {"period", "age", "change", "bus"};
+  for(uint8_t h = 0; h < LATENCY_HISTOGRAMS; h++){
+    LatencyHistogram which = (LatencyHistogram)h;
+    uint8_t p50 = latencyPercentile(which, 50);
+    uint8_t p99 = latencyPercentile(which, 99);
+    if(p50 == LATENCY_BUCKETS){
+      fprintf(stderr, "%s us: none\n", names[h]);
+      continue;
+    }
+    fprintf(stderr, "%s us: p50 %lu+ p99 %lu+ |", names[h], latencyBucketStart(p50), latencyBucketStart(p99));
+    const uint16_t *counts = latencyCounts(which);
+    for(uint8_t b = 0; b < LATENCY_BUCKETS; b++){
+      if(counts[b]){
+        fprintf(stderr, " %lu:%u", latencyBucketStart(b), counts[b]);
+      }
+    }
+    fprintf(stderr, "\n");
+  }
+}
+
+static bool parseMode(const char *name, NeedleMode &mode){
+  static const char *const names[] = {"snap", "animated", "physical", "raster"};
+  for(uint8_t i = 0; i < 4; i++){
+    if(strcmp(name, names[i]) == 0){
+      mode = (NeedleMode)i;
+      return true;
+    }
+  }
+  return false;
+}
+
+int main(int argc, char **argv){
+  NeedleMode mode = NEEDLE_ANIMATED;
+  if(argc < 2 or (argc > 2 and !parseMode(argv[2], mode))){
+    fprintf(stderr, "usage: %s capture.mcap [snap|animated|physical|raster] [tail ms]\n", argv[0]);
+    return 2;
+  }
+  unsigned long tail = argc > 3 ? strtoul(argv[3], NULL, 10) : 1000;
+  if(!load(argv[1])){
+    return 1;
+  }
+
+  halNativeSetMagSource(replaySource);
+  halNativeOnShow(showHook);
+  halNativeSerialEcho(false);
+
+  // Before setup(), which already shows the first reading
+  setNeedleMode(mode);
+  setup();
+  unsigned long end = 0;
+  while(next < readings.size() or halMillis() < end){
+    loop();
+    halNativeAdvance(1);
+    if(next == readings.size() and end == 0){
+      end = halMillis() + tail;
+    }
+  }
+
+  printf("reading,recorded_ms,read_ms,x,y,z,first_show_ms,leds\n");
+  for(size_t i = 0; i < readings.size(); i++){
+    const Reading &r = readings[i];
+    printf("%zu,%lu,%lu,%ld,%ld,%ld,%ld,%s\n", i, r.recorded, r.read, (long)r.sample.x,
+           (long)r.sample.y, (long)r.sample.z, r.firstShow, r.leds);
+  }
+
+  // Latency from the read to the first show, and how even the reads were
+  long lmin = -1, lmax = 0;
+  double lsum = 0;
+  unsigned long shown = 0;
+  double isum = 0, isq = 0;
+  for(size_t i = 0; i < readings.size(); i++){
+    const Reading &r = readings[i];
+    if(r.firstShow >= 0){
+      long latency = r.firstShow - (long)r.read;
+      lmin = lmin < 0 or latency < lmin ? latency : lmin;
+      lmax = latency > lmax ? latency : lmax;
+      lsum += latency;
+      shown++;
+    }
+    if(i > 0){
+      double interval = (double)r.read - readings[i - 1].read;
+      isum += interval;
+      isq += interval * interval;
+    }
+  }
+  size_t intervals = readings.size() > 1 ? readings.size() - 1 : 1;
+  double mean = isum / intervals;
+  fprintf(stderr, "readings %zu, shows %lu, readings shown %lu\n", readings.size(), shows, shown);
+  fprintf(stderr, "latency ms min %ld avg %.2f max %ld\n", lmin, shown ? lsum / shown : 0.0, lmax);
+  fprintf(stderr, "read interval ms avg %.2f jitter %.2f\n", mean, sqrt(fabs(isq / intervals - mean * mean)));
+  printHistograms();
+  fprintf(stderr, "digest %016llx\n", (unsigned long long)digest);
+  return 0;
+}
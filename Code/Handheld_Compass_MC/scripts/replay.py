@@ -0,0 +1,47 @@
+"""Play a magnetometer capture back through the firmware on the host.
+
+    python scripts/replay.py CAPTURE.mcap [--mode animated] [--tail 1000]
+                             [--csv OUT.csv] [--frames FILE]
+
+Every reading in the capture (see scripts/capture.py) is handed to
+the magnetometer code in turn, no earlier than the time it was recorded
+at, while setup() and loop() run on the native HAL, see
+scripts/replay.cpp. The clock is virtual, so a replay runs as
+fast as the host allows and is bit for bit the same on every run and
+every machine. Prints the latency from each read to the first LED show,
+the spacing and jitter of the reads, the latency histograms from
+include/Latency.h (reading period, reading age at each show, reading
+to needle move and I2C transaction time, the last empty here since the
+captured readings skip the bus, each as log2 buckets with p50 and p99),
+and a digest of everything shown: two builds that give the same digest
+lit the same LEDs at the same times. --csv keeps the per reading detail.
+"""
+import argparse
+import os
+import subprocess
+import sys
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+import gen_frames  # noqa: E402
+import host_build  # noqa: E402
+
+DRIVER = os.path.join(gen_frames.PROJECT_DIR, "scripts", "replay.cpp")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("capture")
+    parser.add_argument("--mode", default="animated", choices=["snap", "animated", "physical", "raster"])
+    parser.add_argument("--tail", type=int, default=1000, help="ms to keep running after the last reading")
+    parser.add_argument("--csv", help="write the per reading detail here")
+    parser.add_argument("--frames", default=gen_frames.FRAME_FILE)
+    args = parser.parse_args()
+
+    program = host_build.build(DRIVER, args.frames)
+    out = open(args.csv, "w") if args.csv else subprocess.DEVNULL
+    result = subprocess.run([program, args.capture, args.mode, str(args.tail)], stdout=out)
+    return result.returncode
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,380 @@
+/*--------------------------------------------------------------------
+File:   Needle snapshots for scripts/snapshot.py
+
+Doc:  Runs the LED code on the host against the native HAL and draws
+      what the LEDs show, laid out like the compass, as PPM images or as
+      text. See scripts/snapshot.py for the commands and options.
+
+      Each LED is a disc on its grid position from Layout.h, in the
+      colour held in leds[]. Positions with no LED are left empty.
+--------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <vector>
+#include "NativeHAL.h"
+#include "LED.h"
+#include "Layout.h"
+
+// How long an animated needle gets to come to rest for a still picture
+#define SETTLE_MS 3000
+
+enum TextStyle { TEXT_NONE, TEXT_ANSI, TEXT_PLAIN };
+
+struct Options {
+  NeedleMode mode = NEEDLE_SNAP;
+  bool modeSet = false;
+  const char *ppm = NULL;
+  TextStyle text = TEXT_NONE;
+  float step = 5;
+  int scale = 16;
+  int columns = 12;
+  unsigned long tail = 1000;
+};
+
+// One picture of the LEDs
+struct Shot {
+  unsigned long time;
+  float heading;
+  bool shown;
+  CRGB leds[NUM_LEDS];
+};
+
+static Shot current;
+static std::vector<Shot> *recording;
+
+/********************************************************
+* Keep every picture sent to the LEDs
+********************************************************/
+static void capture(const CRGB *leds, uint8_t count, unsigned long now){
+  memcpy(current.leds, leds, count * sizeof(CRGB));
+  current.time = now;
+  current.shown = true;
+  if(recording){
+    recording->push_back(current);
+  }
+}
+
+/********************************************************
+* Let the needle run for a while, like loop() does
+********************************************************/
+static void runFor(unsigned long ms){
+  for(unsigned long i = 0; i < ms; i++){
+    halNativeAdvance(1);
+    updateLED();
+  }
+}
+
+/********************************************************
+* Show one heading starting from a cleared needle
+********************************************************/
+static Shot still(float heading, NeedleMode mode){
+  // NaN lands in no frame, which clears the needle
+  setNeedleMode(NEEDLE_SNAP);
+  compassHead(NAN);
+  memset(current.leds, 0, sizeof(current.leds));
+  current.shown = false;
+  current.heading = heading;
+
+  setNeedleMode(mode);
+  compassHead(heading);
+  if(mode == NEEDLE_ANIMATED or mode == NEEDLE_PHYSICAL){
+    runFor(SETTLE_MS);
+  }
+  return current;
+}
+
+/********************************************************
+* Text
+********************************************************/
+static void printShot(const Shot &shot, TextStyle style, FILE *out){
+  fprintf(out, "%8lu %7.2f%s\n", shot.time, shot.heading, shot.shown ? "" : " (not shown)");
+  for(int8_t y = 0; y < LAYOUT_HEIGHT; y++){
+    for(int8_t x = 0; x < LAYOUT_WIDTH; x++){
+      uint8_t i = ledIndex(x, y);
+      if(i == LAYOUT_NONE){
+        fputs("  ", out);
+      }else if(style == TEXT_ANSI){
+        const CRGB &c = shot.leds[i];
+        if(c.r or c.g or c.b){
+          fprintf(out, "\x1b[38;2;%d;%d;%dm()\x1b[0m", c.r, c.g, c.b);
+        }else{
+          fputs("\x1b[38;2;60;60;60m()\x1b[0m", out);
+        }
+      }else{
+        char text[2];
+        halNativeLedText(&shot.leds[i], 1, text);
+        fprintf(out, "%c ", text[0]);
+      }
+    }
+    fputc('\n', out);
+  }
+}
+
+/********************************************************
+* Pictures
+********************************************************/
+struct Image {
+  int width;
+  int height;
+  std::vector<uint8_t> pixels;
+
+  Image(int w, int h) : width(w), height(h), pixels(w * h * 3, 16) {}
+
+  void put(int x, int y, const CRGB &c){
+    uint8_t *p = &pixels[(y * width + x) * 3];
+    p[0] = c.r;
+    p[1] = c.g;
+    p[2] = c.b;
+  }
+};
+
+static int tileWidth(const Options &opt){
+  return LAYOUT_WIDTH * opt.scale;
+}
+
+static int tileHeight(const Options &opt){
+  return LAYOUT_HEIGHT * opt.scale;
+}
+
+/********************************************************
+* Draw the LEDs with the top left corner at left, top
+********************************************************/
+static void drawShot(Image &img, const Shot &shot, int left, int top, int scale){
+  const CRGB off(40, 40, 40);
+  float radius = scale * 0.4f;
+
+  for(uint8_t i = 0; i < NUM_LEDS; i++){
+    LedCoord c = ledCoord(i);
+    const CRGB &color = (shot.leds[i].r or shot.leds[i].g or shot.leds[i].b) ? shot.leds[i] : off;
+    for(int py = 0; py < scale; py++){
+      for(int px = 0; px < scale; px++){
+        float dx = px + 0.5f - scale / 2.0f;
+        float dy = py + 0.5f - scale / 2.0f;
+        if(dx * dx + dy * dy <= radius * radius){
+          img.put(left + c.x * scale + px, top + c.y * scale + py, color);
+        }
+      }
+    }
+  }
+}
+
+static void writePpm(const Image &img, FILE *out){
+  fprintf(out, "P6\n%d %d\n255\n", img.width, img.height);
+  fwrite(img.pixels.data(), 1, img.pixels.size(), out);
+}
+
+static FILE *openOutput(const char *path){
+  if(strcmp(path, "-") == 0){
+    return stdout;
+  }
+  FILE *out = fopen(path, "wb");
+  if(!out){
+    perror(path);
+    exit(1);
+  }
+  return out;
+}
+
+/********************************************************
+* Write the shots, as one picture each and as text
+********************************************************/
+static void writeShots(const std::vector<Shot> &shots, const Options &opt){
+  if(opt.ppm){
+    FILE *out = openOutput(opt.ppm);
+    for(const Shot &shot : shots){
+      Image img(tileWidth(opt), tileHeight(opt));
+      drawShot(img, shot, 0, 0, opt.scale);
+      writePpm(img, out);
+    }
+    if(out != stdout){
+      fclose(out);
+    }
+  }
+  if(opt.text != TEXT_NONE){
+    for(const Shot &shot : shots){
+      printShot(shot, opt.text, stdout);
+    }
+  }
+}
+
+/********************************************************
+* Commands
+********************************************************/
+static int frameCommand(float heading, const Options &opt){
+  std::vector<Shot> shots(1, still(heading, opt.mode));
+  writeShots(shots, opt);
+  return 0;
+}
+
+static int sheetCommand(const Options &opt){
+  std::vector<Shot> shots;
+  for(float heading = 0; heading < 360; heading += opt.step){
+    shots.push_back(still(heading, opt.mode));
+  }
+
+  if(opt.ppm){
+    // Tiles left to right, top to bottom, half a cell apart
+    int gap = opt.scale / 2;
+    int rows = (shots.size() + opt.columns - 1) / opt.columns;
+    Image img(opt.columns * (tileWidth(opt) + gap) + gap, rows * (tileHeight(opt) + gap) + gap);
+    for(size_t n = 0; n < shots.size(); n++){
+      int left = gap + (n % opt.columns) * (tileWidth(opt) + gap);
+      int top = gap + (n / opt.columns) * (tileHeight(opt) + gap);
+      drawShot(img, shots[n], left, top, opt.scale);
+    }
+    FILE *out = openOutput(opt.ppm);
+    writePpm(img, out);
+    if(out != stdout){
+      fclose(out);
+    }
+  }
+  if(opt.text != TEXT_NONE){
+    for(const Shot &shot : shots){
+      printShot(shot, opt.text, stdout);
+    }
+  }
+  return 0;
+}
+
+/********************************************************
+* Replay a heading trace, one "<ms> <heading>" per line, and keep
+* every picture the LEDs are sent
+********************************************************/
+static int traceCommand(const char *path, const Options &opt){
+  FILE *in = strcmp(path, "-") == 0 ? stdin : fopen(path, "r");
+  if(!in){
+    perror(path);
+    return 1;
+  }
+
+  std::vector<Shot> shots;
+  recording = &shots;
+  setNeedleMode(opt.mode);
+
+  char line[128];
+  while(fgets(line, sizeof(line), in)){
+    unsigned long when;
+    float heading;
+    if(line[0] == '#' or sscanf(line, "%lu %f", &when, &heading) != 2){
+      continue;
+    }
+    if(when > halMillis()){
+      runFor(when - halMillis());
+    }
+    current.heading = heading;
+    compassHead(heading);
+  }
+  runFor(opt.tail);
+  recording = NULL;
+
+  if(in != stdin){
+    fclose(in);
+  }
+  writeShots(shots, opt);
+  return 0;
+}
+
+/********************************************************
+* Options
+********************************************************/
+static bool parseMode(const char *name, NeedleMode &mode){
+  static const char *const names[] = {"snap", "animated", "physical", "raster"};
+  for(uint8_t i = 0; i < 4; i++){
+    if(strcmp(name, names[i]) == 0){
+      mode = (NeedleMode)i;
+      return true;
+    }
+  }
+  return false;
+}
+
+static int usage(){
+  fputs("usage: snapshot frame <heading> | sheet | trace <file> [options]\n"
+        "  --mode snap|animated|physical|raster\n"
+        "  --ppm FILE    write PPM, - for stdout\n"
+        "  --ansi        print in colour\n"
+        "  --text        print R for red, G for gray, . for off\n"
+        "  --step DEG    sheet spacing, default 5\n"
+        "  --scale PX    pixels per LED, default 16\n"
+        "  --columns N   sheet tiles per row, default 12\n"
+        "  --tail MS     trace run on after the last heading, default 1000\n", stderr);
+  return 2;
+}
+
+int main(int argc, char **argv){
+  if(argc < 2){
+    return usage();
+  }
+
+  const char *command = argv[1];
+  const char *argument = NULL;
+  int first = 2;
+  if(strcmp(command, "frame") == 0 or strcmp(command, "trace") == 0){
+    if(argc < 3){
+      return usage();
+    }
+    argument = argv[2];
+    first = 3;
+  }
+
+  Options opt;
+  for(int i = first; i < argc; i++){
+    const char *arg = argv[i];
+    const char *value = i + 1 < argc ? argv[i + 1] : NULL;
+    if(strcmp(arg, "--ansi") == 0){
+      opt.text = TEXT_ANSI;
+    }else if(strcmp(arg, "--text") == 0){
+      opt.text = TEXT_PLAIN;
+    }else if(!value){
+      return usage();
+    }else if(strcmp(arg, "--mode") == 0){
+      if(!parseMode(value, opt.mode)){
+        return usage();
+      }
+      opt.modeSet = true;
+      i++;
+    }else if(strcmp(arg, "--ppm") == 0){
+      opt.ppm = value;
+      i++;
+    }else if(strcmp(arg, "--step") == 0){
+      opt.step = strtof(value, NULL);
+      i++;
+    }else if(strcmp(arg, "--scale") == 0){
+      opt.scale = atoi(value);
+      i++;
+    }else if(strcmp(arg, "--columns") == 0){
+      opt.columns = atoi(value);
+      i++;
+    }else if(strcmp(arg, "--tail") == 0){
+      opt.tail = strtoul(value, NULL, 10);
+      i++;
+    }else{
+      return usage();
+    }
+  }
+  if(opt.step <= 0 or opt.scale < 2 or opt.columns < 1){
+    return usage();
+  }
+  if(!opt.ppm and opt.text == TEXT_NONE){
+    opt.text = TEXT_ANSI;
+  }
+
+  setupLED();
+  halNativeOnShow(capture);
+
+  if(strcmp(command, "frame") == 0){
+    return frameCommand(strtof(argument, NULL), opt);
+  }
+  if(strcmp(command, "sheet") == 0){
+    return sheetCommand(opt);
+  }
+  if(strcmp(command, "trace") == 0){
+    if(!opt.modeSet){
+      opt.mode = NEEDLE_ANIMATED;
+    }
+    return traceCommand(argument, opt);
+  }
+  return usage();
+}
@@ -0,0 +1,55 @@
+"""Draw what the compass LEDs show, without flashing a unit.
+
+    python scripts/snapshot.py frame <heading> [options]
+    python scripts/snapshot.py sheet [--step 5] [--columns 12] [options]
+    python scripts/snapshot.py trace <file> [--tail 1000] [options]
+
+    options: --mode snap|animated|physical|raster
+             --ppm FILE   PPM output, - for stdout
+             --ansi       colour text on the terminal, the default
+             --text       R for red, G for gray, . for off
+             --scale PX   pixels per LED, default 16
+             --frames F   frame file, default frames/needle_frames.txt
+
+The LED code runs on the host (scripts/host_build.py builds it with
+scripts/snapshot.cpp) and every LED is drawn where it sits on the
+compass. frame draws one heading, sheet draws every --step degrees
+round the dial on one contact sheet. trace replays a heading trace,
+one "<milliseconds> <heading>" per line, through the chosen needle mode
+(animated by default) with updateLED() running every millisecond, and
+draws every picture the LEDs were sent. Several PPM pictures are written
+one after another, which ffmpeg reads with -f image2pipe.
+
+For animated and physical needles frame and sheet let the needle come
+to rest first. The --text output of a trace is stable, so it can be kept
+and diffed to catch changes in animation or filtering.
+"""
+import os
+import subprocess
+import sys
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+import gen_frames  # noqa: E402
+import host_build  # noqa: E402
+
+DRIVER = os.path.join(gen_frames.PROJECT_DIR, "scripts", "snapshot.cpp")
+
+
+def main():
+    args = sys.argv[1:]
+    frame_file = gen_frames.FRAME_FILE
+    if "--frames" in args:
+        i = args.index("--frames")
+        if i + 1 >= len(args):
+            sys.exit(__doc__)
+        frame_file = args[i + 1]
+        del args[i:i + 2]
+    if not args or args[0] in ("-h", "--help"):
+        print(__doc__)
+        return 0
+    program = host_build.build(DRIVER, frame_file)
+    return subprocess.run([program] + args).returncode
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,124 @@
+/*--------------------------------------------------------------------
+File:   Telemetry to CSV
+
+Doc:  Reads the telemetry stream from include/Telemetry.h, from a file,
+      a serial device set up with stty, or stdin, and prints one CSV line
+      per good frame. Frames that fail COBS or the CRC are skipped, as is
+      the start up text. Gaps in the sequence are counted and, with the
+      dropped field, reported at the end.
+
+      c++ -std=gnu++17 -Iinclude -Inative/include scripts/telemetry_decode.cpp src/Crc.cpp -o telemetry_decode
+      stty -F /dev/ttyUSB0 115200 raw && ./telemetry_decode /dev/ttyUSB0 > run.csv
+--------------------------------------------------------------------*/
+#include <stdio.h>
+#include <string.h>
+#include "Telemetry.h"
+#include "Crc.h"
+
+static unsigned long good;
+static unsigned long bad;
+static unsigned long lost;
+static unsigned long droppedOnBoard;
+static bool haveSequence;
+static uint16_t lastSequence;
+
+static uint16_t get16(const uint8_t *p){
+  return p[0] | (p[1] << 8);
+}
+
+static uint32_t get32(const uint8_t *p){
+  return get16(p) | ((uint32_t)get16(p + 2) << 16);
+}
+
+static int32_t get24(const uint8_t *p){
+  int32_t value = p[0] | ((int32_t)p[1] << 8) | ((int32_t)p[2] << 16);
+  return value & 0x800000 ? value - 0x1000000 : value;
+}
+
+/********************************************************
+* Undo COBS, the 0 that ended the frame is already gone
+* @return the decoded length, or -1 if it is not valid COBS
+********************************************************/
+static int unstuff(const uint8_t *in, int length, uint8_t *out, int room){
+  int n = 0;
+  int i = 0;
+  while(i < length){
+    uint8_t code = in[i++];
+    if(code == 0 or i + code - 1 > length){
+      return -1;
+    }
+    for(uint8_t k = 1; k < code; k++){
+      if(n == room){
+        return -1;
+      }
+      out[n++] = in[i++];
+    }
+    if(code < 0xFF and i < length){
+      if(n == room){
+        return -1;
+      }
+      out[n++] = 0;
+    }
+  }
+  return n;
+}
+
+static void frame(const uint8_t *in, int length){
+  uint8_t p[TELEMETRY_PAYLOAD + 1];
+  if(unstuff(in, length, p, sizeof(p)) != TELEMETRY_PAYLOAD or p[0] != TELEMETRY_VERSION or
+     crc8(p, TELEMETRY_PAYLOAD - 1) != p[TELEMETRY_PAYLOAD - 1]){
+    bad++;
+    return;
+  }
+
+  uint16_t sequence = get16(&p[1]);
+  if(haveSequence){
+    lost += (uint16_t)(sequence - lastSequence - 1);
+  }
+  haveSequence = true;
+  lastSequence = sequence;
+  droppedOnBoard += p[23];
+  good++;
+
+  uint16_t heading = get16(&p[16]);
+  printf("%u,%lu,%ld,%ld,%ld,", sequence, (unsigned long)get32(&p[3]),
+         (long)get24(&p[7]), (long)get24(&p[10]), (long)get24(&p[13]));
+  if(heading == TELEMETRY_NO_HEADING){
+    printf(",");
+  }else{
+    printf("%u.%02u,", heading / 100, heading % 100);
+  }
+  printf("%u,%u,%u,%u\n", p[18], get16(&p[19]), get16(&p[21]), p[23]);
+}
+
+int main(int argc, char **argv){
+  FILE *in = argc > 1 ? fopen(argv[1], "rb") : stdin;
+  if(!in){
+    perror(argv[1]);
+    return 1;
+  }
+
+  printf("sequence,time_ms,x,y,z,heading,frame,read_us,draw_us,dropped\n");
+  uint8_t buffer[256];
+  int length = 0;
+  bool overflow = false;
+  int c;
+  while((c = fgetc(in)) != EOF){
+    if(c == 0){
+      if(length > 0 and !overflow){
+        frame(buffer, length);
+      }
+      length = 0;
+      overflow = false;
+    }else if(length < (int)sizeof(buffer)){
+      buffer[length++] = c;
+    }else{
+      overflow = true;
+    }
+    fflush(stdout);
+  }
+
+  fprintf(stderr, "%lu frames, %lu bad, %lu lost on the way, %lu dropped on the compass\n",
+          good, bad, lost, droppedOnBoard);
+  return 0;
+}
@@ -0,0 +1,144 @@
+/*--------------------------------------------------------------------
+File:   Needle animation
+
+Doc:  Sweeps the needle through the frames between the one it shows and
+      its target, one frame per period, the short way around the dial.
+      The caller passes in the time, so nothing here waits. If the loop
+      was late, or the target ran more than ANIMATION_MAX_LAG_DEG
+      ahead, the frames in between are dropped rather than played late.
+      The lag is measured between the frames' angles, see frameAngle(),
+      as the frames are packed tighter in some parts of the dial.
+--------------------------------------------------------------------*/
+#include "Animation.h"
+#include "Frames.h"
+
+static uint8_t currentFrame = FRAME_NONE;
+static uint8_t targetFrame = FRAME_NONE;
+static uint16_t stepPeriod = 1000 / ANIMATION_FPS;
+static unsigned long lastStep;
+static uint16_t droppedFrames;
+
+// ANIMATION_MAX_LAG_DEG as a binary angle, see frameAngle()
+#define MAX_LAG_ANGLE ((uint16_t)(ANIMATION_MAX_LAG_DEG * 65536UL / 360))
+
+/******************************************************** 
+* Signed number of frames from one frame to another the short way around.
+* The way is picked by angle, the frames are not evenly spread
+********************************************************/
+static int8_t ringDistance(uint8_t from, uint8_t to){
+  int16_t d = (int16_t)to - from;
+  bool clockwise = (int16_t)(frameAngle(to) - frameAngle(from)) >= 0;
+
+  if(clockwise and d < 0){
+    d += NUM_FRAMES;
+  }else if(!clockwise and d > 0){
+    d -= NUM_FRAMES;
+  }
+  return d;
+}
+
+/******************************************************** 
+* The frame steps frames on from another, wrapping around the dial
+********************************************************/
+static uint8_t stepFrame(uint8_t frame, int16_t steps){
+  int16_t next = frame + steps;
+
+  if(next < 0){
+    next += NUM_FRAMES;
+  }else if(next >= NUM_FRAMES){
+    next -= NUM_FRAMES;
+  }
+  return next;
+}
+
+/******************************************************** 
+* Angle between two frames the short way around, as a binary angle
+********************************************************/
+static uint16_t lagAngle(uint8_t from, uint8_t to){
+  int16_t d = frameAngle(to) - frameAngle(from);
+  return d < 0 ? -d : d;
+}
+
+/******************************************************** 
+* Set the target frame
+********************************************************/
+void animationSetTarget(uint8_t frame){
+  if(frame < NUM_FRAMES){
+    targetFrame = frame;
+  }
+}
+
+/******************************************************** 
+* Place the needle
+********************************************************/
+void animationJump(uint8_t frame, unsigned long now){
+  if(frame < NUM_FRAMES){
+    currentFrame = frame;
+    targetFrame = frame;
+    lastStep = now;
+  }
+}
+
+/******************************************************** 
+* Set the frame rate
+********************************************************/
+void animationSetRate(uint8_t fps){
+  if(fps == 0){
+    fps = 1;
+  }
+  stepPeriod = 1000 / fps;
+}
+
+/******************************************************** 
+* Move the needle by however many frames are due
+********************************************************/
+uint8_t animationStep(unsigned long now){
+  if(targetFrame == FRAME_NONE){
+    return FRAME_NONE;
+  }
+
+  // The first heading is shown straight away
+  if(currentFrame == FRAME_NONE){
+    currentFrame = targetFrame;
+    lastStep = now;
+    return currentFrame;
+  }
+
+  if(currentFrame == targetFrame){
+    lastStep = now;
+    return FRAME_NONE;
+  }
+
+  unsigned long elapsed = now - lastStep;
+  if(elapsed < stepPeriod){
+    return FRAME_NONE;
+  }
+
+  // Frames that were due while the loop was busy
+  unsigned long due = elapsed / stepPeriod;
+  lastStep += due * stepPeriod;
+
+  int8_t distance = ringDistance(currentFrame, targetFrame);
+  uint8_t remaining = distance < 0 ? -distance : distance;
+  int8_t direction = distance < 0 ? -1 : 1;
+
+  uint8_t steps = due < remaining ? due : remaining;
+
+  // Never trail the target by more than the allowed lag
+  while(steps < remaining and
+        lagAngle(stepFrame(currentFrame, direction * steps), targetFrame) > MAX_LAG_ANGLE){
+    steps++;
+  }
+  droppedFrames += steps - 1;
+
+  currentFrame = stepFrame(currentFrame, direction * steps);
+
+  return currentFrame;
+}
+
+/******************************************************** 
+* Frames skipped so far
+********************************************************/
+uint16_t animationDroppedFrames(){
+  return droppedFrames;
+}
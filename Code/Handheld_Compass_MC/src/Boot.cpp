@@ -0,0 +1,56 @@
+/*--------------------------------------------------------------------
+File:   Boot timeline
+
+Doc:  Keeps the time of each step in Boot.h for the report setup()
+      prints once serial is up. With -DBOOT_PIN the first frame also
+      raises that pin.
+--------------------------------------------------------------------*/
+#include "Boot.h"
+#include "HAL.h"
+#if defined(BOOT_PIN) and defined(__AVR__)
+#include <Arduino.h>
+#endif
+
+static unsigned long marks[BOOT_MARKS];
+static uint8_t marked;
+
+static const char *const markNames[BOOT_MARKS] = {
+  "setup", "leds", "sensor", "reading", "frame", "serial"
+};
+
+static_assert(BOOT_MARKS <= 8, "marked has a bit per mark");
+
+void bootMark(BootMark mark){
+  if(marked & (1 << mark)){
+    return;
+  }
+  marked |= 1 << mark;
+  marks[mark] = halMicros();
+
+  // For timing the first frame from power on with a logic analyser
+#if defined(BOOT_PIN) and defined(__AVR__)
+  if(mark == BOOT_FIRST_FRAME){
+    pinMode(BOOT_PIN, OUTPUT);
+    digitalWrite(BOOT_PIN, HIGH);
+  }
+#endif
+}
+
+unsigned long bootTime(BootMark mark){
+  return marks[mark];
+}
+
+void bootReport(){
+  halSerialPrint("boot us:");
+  for(uint8_t m = 0; m < BOOT_MARKS; m++){
+    halSerialPrint(" ");
+    halSerialPrint(markNames[m]);
+    halSerialPrint(" ");
+    if(marked & (1 << m)){
+      halSerialPrint((long)marks[m]);
+    }else{
+      halSerialPrint("-");
+    }
+  }
+  halSerialPrintln();
+}
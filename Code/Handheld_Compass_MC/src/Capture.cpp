@@ -0,0 +1,52 @@
+/*--------------------------------------------------------------------
+File:   Raw magnetometer capture
+
+Doc:  Packs readings into the 13 byte records described in Capture.h
+      and writes them to the serial port. At the 5 Hz sample rate that
+      is 65 bytes a second, well inside what 115200 baud carries.
+--------------------------------------------------------------------*/
+#include "Capture.h"
+#include "Pack.h"
+
+static unsigned long lastRecord;
+static bool started;
+
+/******************************************************** 
+* Write the header
+********************************************************/
+void captureBegin(){
+  uint8_t header[5] = {'M', 'C', 'A', 'P', CAPTURE_VERSION};
+  halSerialWrite(header, sizeof(header));
+  lastRecord = 0;
+  started = true;
+}
+
+/******************************************************** 
+* Write one record
+********************************************************/
+void captureSample(unsigned long now, const MagSample &sample){
+  // The reading setup() shows before serial is up
+  if(!started){
+    return;
+  }
+
+  unsigned long dt = now - lastRecord;
+  if(dt > 0xFFFF){
+    dt = 0xFFFF;
+  }
+  lastRecord = now;
+
+  uint8_t record[CAPTURE_RECORD_BYTES];
+  record[0] = CAPTURE_SYNC;
+  uint8_t *p = put16(&record[1], dt);
+  p = put24(p, sample.x);
+  p = put24(p, sample.y);
+  put24(p, sample.z);
+
+  uint8_t sum = 0;
+  for(uint8_t i = 1; i < CAPTURE_RECORD_BYTES - 1; i++){
+    sum += record[i];
+  }
+  record[CAPTURE_RECORD_BYTES - 1] = sum;
+  halSerialWrite(record, sizeof(record));
+}
@@ -0,0 +1,95 @@
+/*--------------------------------------------------------------------
+File:   Frame compositor
+
+Doc:  The needle is drawn into its own base layer. Status indicators
+      (searching, calibration, interference, battery) are kept as short
+      lists of lit LEDs per overlay layer and painted over the needle in
+      priority order, once per frame, just before halLedShow().
+      Everything is statically allocated.
+--------------------------------------------------------------------*/
+#include <string.h>
+#include "Compositor.h"
+#include "LED.h"
+
+struct Overlay {
+  uint8_t count;
+  uint8_t index[OVERLAY_MAX_PIXELS];
+  CRGB color[OVERLAY_MAX_PIXELS];
+};
+
+static Overlay overlays[NUM_OVERLAYS];
+
+// Set when an overlay changed since the last composite, which means LEDs
+// it used to cover have to be restored from the needle
+static bool overlaysChanged = true;
+
+/******************************************************** 
+* Light an LED on an overlay layer, replacing its color if it is already lit
+********************************************************/
+bool overlaySetPixel(OverlayLayer layer, uint8_t index, const CRGB &color){
+  if(index >= NUM_LEDS){
+    return false;
+  }
+
+  Overlay &o = overlays[layer];
+  index = boardLed(index);
+
+  for(uint8_t i = 0; i < o.count; i++){
+    if(o.index[i] == index){
+      o.color[i] = color;
+      overlaysChanged = true;
+      return true;
+    }
+  }
+
+  if(o.count >= OVERLAY_MAX_PIXELS){
+    return false;
+  }
+
+  o.index[o.count] = index;
+  o.color[o.count] = color;
+  o.count++;
+  overlaysChanged = true;
+  return true;
+}
+
+/******************************************************** 
+* Clear an overlay layer
+********************************************************/
+void overlayClear(OverlayLayer layer){
+  if(overlays[layer].count){
+    overlays[layer].count = 0;
+    overlaysChanged = true;
+  }
+}
+
+/******************************************************** 
+* Copy the needle into the output, then paint each overlay on top from 
+* lowest to highest priority. At most NUM_OVERLAYS * OVERLAY_MAX_PIXELS 
+* writes follow the copy, which keeps this well under 100us at 16MHz.
+* When the overlays did not change only the dirty needle LEDs are copied.
+********************************************************/
+void compositeFrame(const CRGB *needle, CRGB *out, uint8_t count, const uint8_t *dirty){
+  if(dirty == NULL or overlaysChanged){
+    memcpy(out, needle, count * sizeof(CRGB));
+    overlaysChanged = false;
+  }else{
+    for(uint8_t b = 0; b * 8 < count; b++){
+      uint8_t i = b * 8;
+      for(uint8_t bits = dirty[b]; bits; bits >>= 1, i++){
+        if((bits & 1) and i < count){
+          out[i] = needle[i];
+        }
+      }
+    }
+  }
+
+  for(uint8_t layer = 0; layer < NUM_OVERLAYS; layer++){
+    const Overlay &o = overlays[layer];
+    for(uint8_t i = 0; i < o.count; i++){
+      if(o.index[i] < count){
+        out[o.index[i]] = o.color[i];
+      }
+    }
+  }
+}
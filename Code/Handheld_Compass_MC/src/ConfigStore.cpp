@@ -0,0 +1,154 @@
+/*--------------------------------------------------------------------
+File:   EEPROM settings
+
+Doc:  Loading reads the 3 byte head of every slot in one pass and takes
+      the newest sequence number, counting round a 16 bit wrap, so only
+      that one record is read in full and checked. Records are written
+      in slot order, so if its CRC fails (power lost while writing) the
+      one before it in the ring is the next newest, and so on back.
+
+      A write snapshots the record and copies it a byte at a time as the
+      EEPROM becomes ready, crc last. A torn record keeps the old crc of
+      its slot, which a CRC-16 lets through 1 time in 65536.
+      Changes made while a write is going on start another one after it.
+--------------------------------------------------------------------*/
+#include <string.h>
+#include "ConfigStore.h"
+#include "Crc.h"
+
+static_assert(CONFIG_BLOCK_COUNT <= 8, "stored has a bit per block");
+static_assert(CONFIG_SLOTS >= 2, "the ring needs at least two slots");
+static_assert(CONFIG_VERSION != 0xFF, "0xFF is erased EEPROM");
+
+static const uint8_t blockSize[CONFIG_BLOCK_COUNT] = {
+#define CONFIG_BLOCK_ENTRY(name, size) size,
+  CONFIG_BLOCKS(CONFIG_BLOCK_ENTRY)
+#undef CONFIG_BLOCK_ENTRY
+};
+
+// The record as it stands in RAM, laid out as in EEPROM
+static uint8_t record[CONFIG_RECORD];
+#define RECORD_SEQUENCE 0
+#define RECORD_VERSION  2
+#define RECORD_STORED   3
+#define RECORD_BLOCKS   4
+#define RECORD_CRC      (CONFIG_RECORD - 2)
+
+static uint8_t newestSlot = CONFIG_SLOTS - 1;
+static bool dirty;
+static unsigned long lastChange;
+
+// The record being written and how far it got
+static uint8_t writing[CONFIG_RECORD];
+static uint8_t writeSlot;
+static uint8_t writeIndex = CONFIG_RECORD;
+
+static uint16_t slotAddress(uint8_t slot){
+  return (uint16_t)slot * CONFIG_RECORD;
+}
+
+static uint8_t blockOffset(ConfigBlock block){
+  uint8_t offset = RECORD_BLOCKS;
+  for(uint8_t b = 0; b < block; b++){
+    offset += blockSize[b];
+  }
+  return offset;
+}
+
+/******************************************************** 
+* Read a whole slot into record and check it
+********************************************************/
+static bool loadSlot(uint8_t slot){
+  uint16_t address = slotAddress(slot);
+  for(uint8_t i = 0; i < CONFIG_RECORD; i++){
+    record[i] = halEepromRead(address + i);
+  }
+  uint16_t crc = record[RECORD_CRC] | (record[RECORD_CRC + 1] << 8);
+  return record[RECORD_VERSION] == CONFIG_VERSION and crc16(record, RECORD_CRC) == crc;
+}
+
+void configBegin(){
+  // Find the newest sequence among slots of this version
+  bool found = false;
+  uint16_t newest = 0;
+  uint8_t slot = 0;
+  for(uint8_t s = 0; s < CONFIG_SLOTS; s++){
+    uint16_t address = slotAddress(s);
+    if(halEepromRead(address + RECORD_VERSION) != CONFIG_VERSION){
+      continue;
+    }
+    uint16_t sequence = halEepromRead(address) | (halEepromRead(address + 1) << 8);
+    if(!found or (int16_t)(sequence - newest) > 0){
+      found = true;
+      newest = sequence;
+      slot = s;
+    }
+  }
+
+  // Walk back from it to the first one that checks out
+  for(uint8_t tries = 0; found and tries < CONFIG_SLOTS; tries++){
+    if(loadSlot(slot)){
+      newestSlot = slot;
+      dirty = false;
+      return;
+    }
+    slot = slot == 0 ? CONFIG_SLOTS - 1 : slot - 1;
+  }
+
+  // Nothing saved yet, the first record goes in slot 0
+  memset(record, 0, sizeof(record));
+  newestSlot = CONFIG_SLOTS - 1;
+  dirty = false;
+}
+
+bool configGet(ConfigBlock block, void *out, uint8_t size){
+  if(block >= CONFIG_BLOCK_COUNT or size != blockSize[block] or
+     !(record[RECORD_STORED] & (1 << block))){
+    return false;
+  }
+  memcpy(out, &record[blockOffset(block)], size);
+  return true;
+}
+
+void configSet(ConfigBlock block, const void *data, uint8_t size){
+  if(block >= CONFIG_BLOCK_COUNT or size != blockSize[block]){
+    return;
+  }
+  uint8_t *at = &record[blockOffset(block)];
+  if((record[RECORD_STORED] & (1 << block)) and memcmp(at, data, size) == 0){
+    return;
+  }
+  memcpy(at, data, size);
+  record[RECORD_STORED] |= 1 << block;
+  dirty = true;
+  lastChange = halMillis();
+}
+
+void configPoll(unsigned long now){
+  // Start a new record once the changes have settled
+  if(writeIndex == CONFIG_RECORD){
+    if(!dirty or now - lastChange < CONFIG_WRITE_DELAY){
+      return;
+    }
+    uint16_t sequence = (record[RECORD_SEQUENCE] | (record[RECORD_SEQUENCE + 1] << 8)) + 1;
+    record[RECORD_SEQUENCE] = sequence;
+    record[RECORD_SEQUENCE + 1] = sequence >> 8;
+    record[RECORD_VERSION] = CONFIG_VERSION;
+    uint16_t crc = crc16(record, RECORD_CRC);
+    record[RECORD_CRC] = crc;
+    record[RECORD_CRC + 1] = crc >> 8;
+    memcpy(writing, record, sizeof(writing));
+
+    newestSlot = newestSlot + 1 == CONFIG_SLOTS ? 0 : newestSlot + 1;
+    writeSlot = newestSlot;
+    writeIndex = 0;
+    dirty = false;
+  }
+
+  // One byte per call, the EEPROM takes 3.4 ms over each
+  if(!halEepromReady()){
+    return;
+  }
+  halEepromWrite(slotAddress(writeSlot) + writeIndex, writing[writeIndex]);
+  writeIndex++;
+}
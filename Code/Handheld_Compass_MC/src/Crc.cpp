@@ -0,0 +1,33 @@
+/*--------------------------------------------------------------------
+File:   CRC-8 and CRC-16
+
+Doc:  Bit at a time, no table, so it costs no flash or RAM beyond the
+      loop. About 100 cycles a byte on the AVR, fine for the few dozen
+      bytes it ever checks at once. Needs nothing from the HAL so the
+      host tools in scripts/ can link it on its own.
+--------------------------------------------------------------------*/
+#include "Crc.h"
+
+uint8_t crc8(const void *data, uint8_t length){
+  const uint8_t *p = (const uint8_t *)data;
+  uint8_t crc = 0;
+  for(uint8_t i = 0; i < length; i++){
+    crc ^= p[i];
+    for(uint8_t bit = 0; bit < 8; bit++){
+      crc = crc & 0x80 ? (crc << 1) ^ 0x07 : crc << 1;
+    }
+  }
+  return crc;
+}
+
+uint16_t crc16(const void *data, uint8_t length){
+  const uint8_t *p = (const uint8_t *)data;
+  uint16_t crc = 0xFFFF;
+  for(uint8_t i = 0; i < length; i++){
+    crc ^= (uint16_t)p[i] << 8;
+    for(uint8_t bit = 0; bit < 8; bit++){
+      crc = crc & 0x8000 ? (crc << 1) ^ 0x1021 : crc << 1;
+    }
+  }
+  return crc;
+}
@@ -0,0 +1,91 @@
+/*--------------------------------------------------------------------
+File:   Needle frame table
+
+Doc:  Every needle image that compassHead() can show, stored as a red
+      and a gray bit mask in flash, plus the heading ranges that select
+      them. The frames themselves are drawn in frames/needle_frames.txt
+      and turned into a table at build time. Frames are numbered
+      clockwise from north, so neighbouring numbers are neighbouring
+      needle positions.
+
+      The ranges were measured against the top of the compass, so the
+      east half of the dial is looked up with (360 - heading) and the
+      west half with the heading itself, exactly as it was measured.
+      Headings in the small gaps between the two halves select no frame.
+
+      Frames are written with layout LED numbers and moved to data line
+      order for the board at compile time, see Board.h.
+--------------------------------------------------------------------*/
+#include <Arduino.h>
+#include "Frames.h"
+
+// Pack a 64 bit LED set into bytes, lowest LED first
+#define MASK(v) { (uint8_t)(v), (uint8_t)((v) >> 8), (uint8_t)((v) >> 16), \
+                  (uint8_t)((v) >> 24), (uint8_t)((v) >> 32), (uint8_t)((v) >> 40) }
+#define FRAME(red, gray) { MASK(boardMask(red)), MASK(boardMask(gray)) }
+
+static_assert(FRAME_BYTES == 6, "MASK() packs 6 bytes per frame");
+
+// Frame masks, heading ranges and frame angles, generated from frames/needle_frames.txt
+// by scripts/gen_frames.py
+#include "FrameTable.inc"
+
+static_assert(EAST_RANGES + WEST_RANGES == NUM_FRAMES, "every frame needs a range");
+static_assert(EAST_RANGES - 1 == FRAME_SOUTH, "east half ends at south");
+
+/******************************************************** 
+* Binary search for the first range whose upper end is >= value
+********************************************************/
+static uint8_t findRange(const float *upper, uint8_t count, float value){
+  uint8_t lo = 0;
+  uint8_t hi = count - 1;
+
+  while(lo < hi){
+    uint8_t mid = (lo + hi) / 2;
+    if(value <= pgm_read_float(&upper[mid])){
+      hi = mid;
+    }else{
+      lo = mid + 1;
+    }
+  }
+  return lo;
+}
+
+/******************************************************** 
+* Given a heading from 0-360 degrees, pick the needle frame. This keeps the
+* exact comparisons of the original if/else chain, including its gaps.
+********************************************************/
+uint8_t frameForHeading(float heading){
+  float flipped = 360 - heading;
+
+  if(flipped > EAST_WRAP or flipped <= pgm_read_float(&eastUpper[EAST_RANGES - 1])){
+    if(flipped > EAST_WRAP){
+      return FRAME_NORTH;
+    }
+    return findRange(eastUpper, EAST_RANGES, flipped);
+  }
+
+  if(heading > WEST_LOWER and heading <= pgm_read_float(&westUpper[WEST_RANGES - 1])){
+    return NUM_FRAMES - 1 - findRange(westUpper, WEST_RANGES, heading);
+  }
+
+  return FRAME_NONE;
+}
+
+/******************************************************** 
+* The angle a frame shows
+********************************************************/
+uint16_t frameAngle(uint8_t frame){
+  return pgm_read_word(&frameCentre[frame]);
+}
+
+/******************************************************** 
+* Copy a frame out of flash
+********************************************************/
+void readFrame(uint8_t frame, NeedleFrame &out){
+  if(frame >= NUM_FRAMES){
+    memset(&out, 0, sizeof(out));
+    return;
+  }
+  memcpy_P(&out, &frames[frame], sizeof(out));
+}
@@ -0,0 +1,130 @@
+/*--------------------------------------------------------------------
+File:   Latency histograms
+
+Doc:  Fills the histograms in Latency.h from four hooks: a reading, the
+      frame it asks for, each LED show and each I2C transaction. A needle
+      move is timed from the first reading that asks for a new frame to
+      the next show, so a sweep through several frames counts once, from
+      its start.
+--------------------------------------------------------------------*/
+#include <string.h>
+#include "Latency.h"
+#include "HAL.h"
+#include "Frames.h"
+
+// Bucket 0 is under 1 << (LATENCY_SHIFT + 1) us
+#define LATENCY_SHIFT 7
+
+static uint16_t counts[LATENCY_HISTOGRAMS][LATENCY_BUCKETS];
+
+static const char *const histogramNames[LATENCY_HISTOGRAMS] = {
+  "period", "age", "change", "bus"
+};
+
+static bool haveSample;
+static unsigned long sampleTime;
+
+static uint8_t targetFrame = FRAME_NONE;
+static bool changePending;
+static unsigned long changeTime;
+
+uint8_t latencyBucket(unsigned long us){
+  uint8_t bucket = 0;
+  for(us >>= LATENCY_SHIFT + 1; us and bucket < LATENCY_BUCKETS - 1; us >>= 1){
+    bucket++;
+  }
+  return bucket;
+}
+
+unsigned long latencyBucketStart(uint8_t bucket){
+  return bucket == 0 ? 0 : (1UL << LATENCY_SHIFT) << bucket;
+}
+
+static void add(LatencyHistogram which, unsigned long us){
+  uint16_t &count = counts[which][latencyBucket(us)];
+  if(count < 0xFFFF){
+    count++;
+  }
+}
+
+void latencySample(unsigned long us){
+  if(haveSample){
+    add(LATENCY_PERIOD, us - sampleTime);
+  }
+  haveSample = true;
+  sampleTime = us;
+}
+
+void latencyTarget(uint8_t frame){
+  if(frame == FRAME_NONE or frame == targetFrame){
+    return;
+  }
+  // The first target only sets where the needle starts
+  if(targetFrame != FRAME_NONE and !changePending){
+    changePending = true;
+    changeTime = sampleTime;
+  }
+  targetFrame = frame;
+}
+
+void latencyShow(){
+  unsigned long now = halMicros();
+  if(haveSample){
+    add(LATENCY_AGE, now - sampleTime);
+  }
+  if(changePending){
+    add(LATENCY_CHANGE, now - changeTime);
+    changePending = false;
+  }
+}
+
+void latencyBus(unsigned long us){
+  add(LATENCY_BUS, us);
+}
+
+const uint16_t *latencyCounts(LatencyHistogram which){
+  return counts[which];
+}
+
+uint8_t latencyPercentile(LatencyHistogram which, uint8_t percent){
+  uint32_t total = 0;
+  for(uint8_t b = 0; b < LATENCY_BUCKETS; b++){
+    total += counts[which][b];
+  }
+  if(total == 0){
+    return LATENCY_BUCKETS;
+  }
+
+  uint32_t wanted = (total * percent + 99) / 100;
+  uint32_t seen = 0;
+  for(uint8_t b = 0; b < LATENCY_BUCKETS; b++){
+    seen += counts[which][b];
+    if(seen >= wanted){
+      return b;
+    }
+  }
+  return LATENCY_BUCKETS - 1;
+}
+
+void latencyReport(){
+  for(uint8_t h = 0; h < LATENCY_HISTOGRAMS; h++){
+    halSerialPrint(histogramNames[h]);
+    halSerialPrint(" us from:count");
+    for(uint8_t b = 0; b < LATENCY_BUCKETS; b++){
+      if(counts[h][b]){
+        halSerialPrint(" ");
+        halSerialPrint((long)latencyBucketStart(b));
+        halSerialPrint(":");
+        halSerialPrint((long)counts[h][b]);
+      }
+    }
+    halSerialPrintln();
+  }
+}
+
+void latencyReset(){
+  memset(counts, 0, sizeof(counts));
+  haveSample = false;
+  changePending = false;
+  targetFrame = FRAME_NONE;
+}
@@ -0,0 +1,32 @@
+/*--------------------------------------------------------------------
+File:   LED layout
+
+Doc:  Flash copies of the compile time layout tables in Layout.h, for
+      code that looks LEDs up by position at run time.
+--------------------------------------------------------------------*/
+#include <Arduino.h>
+#include "Layout.h"
+
+static const LayoutTables layout PROGMEM = layoutTables;
+
+/******************************************************** 
+* Grid position of an LED
+********************************************************/
+LedCoord ledCoord(uint8_t index){
+  LedCoord c = {-1, -1};
+  if(index < NUM_LEDS){
+    c.x = pgm_read_byte(&layout.coord[index].x);
+    c.y = pgm_read_byte(&layout.coord[index].y);
+  }
+  return c;
+}
+
+/******************************************************** 
+* LED at a grid position
+********************************************************/
+uint8_t ledIndex(int8_t x, int8_t y){
+  if(x < 0 or x >= LAYOUT_WIDTH or y < 0 or y >= LAYOUT_HEIGHT){
+    return LAYOUT_NONE;
+  }
+  return pgm_read_byte(&layout.index[y][x]);
+}
@@ -5,63 +5,166 @@ File:   Magnetometer functions
 
 Doc:  oNLY
 --------------------------------------------------------------------*/
-#include <Adafruit_MMC56x3.h>
+#include <math.h>
+#include "HAL.h"
 #include "Magnetometer.h"
+#include "Capture.h"
+#include "Telemetry.h"
+#include "Debug.h"
+#include "Profile.h"
+#include "Latency.h"
+#include "ConfigStore.h"
+#include "SampleRing.h"
 
-//Magnetic offsets
-#define OFFSET_X -62.28
-#define OFFSET_y 140.35
+// Hard iron offsets, in micro-Tesla
+static float offsetX = OFFSET_X;
+static float offsetY = OFFSET_y;
 
-/* Assign a unique ID to this sensor at the same time */
-Adafruit_MMC5603 mmc = Adafruit_MMC5603(12345);
+// The offsets as saved in EEPROM, see ConfigStore.h
+struct CalibrationConfig {
+  float x;
+  float y;
+};
+
+static_assert(sizeof(CalibrationConfig) == 8, "CONFIG_CALIBRATION is 8 bytes");
+
+// Wait before trying a missing sensor again, doubled after every failed
+// try up to MAG_RETRY_MAX, in ms
+#define MAG_RETRY_MIN 50
+#define MAG_RETRY_MAX 3200
+
+// Timed readings in a row that fail before the sensor is started again,
+// a NACK now and then on its own is let go
+#define MAG_FAILED_READINGS 3
+
+static bool sensorReady;
+static uint16_t retryDelay = MAG_RETRY_MIN;
+static unsigned long lastTry;
+
+// Readings from the timer, see SampleRing.h. samplePeriod is 0 until
+// startMagnetometerSampling()
+static SampleRing ring;
+static uint16_t samplePeriod;
+static uint8_t droppedSeen;
+static unsigned long dropped;
+static uint8_t failedReadings;
+
+/******************************************************** 
+* Start the timer on an empty ring
+********************************************************/
+static void startSampling(){
+  halMagSampleStop();
+  ringClear(ring);
+  halMagSampleStart(samplePeriod, ring);
+}
+
+/******************************************************** 
+* Start the sensor, or restart it after it went missing. The timer is
+* stopped while it starts and goes on afterwards if it was running
+********************************************************/
+static bool startSensor(){
+  halMagSampleStop();
+  sensorReady = halMagBegin();
+  lastTry = halMillis();
+  failedReadings = 0;
+  if(sensorReady){
+    retryDelay = MAG_RETRY_MIN;
+    if(samplePeriod){
+      startSampling();
+    }
+  }
+  return sensorReady;
+}
+
+/******************************************************** 
+* The sensor stopped answering, retryMagnetometer() looks for it again
+********************************************************/
+static void lostSensor(){
+  sensorReady = false;
+  retryDelay = MAG_RETRY_MIN;
+  lastTry = halMillis();
+}
 
 /******************************************************** 
 * Initialize magnetometer
 ********************************************************/
 void setupMagnetometer() {
-  Serial.begin(115200);
-  while (!Serial)
-    delay(10); // will pause Zero, Leonardo, etc until serial console opens
+  CalibrationConfig saved;
+  if(configGet(CONFIG_CALIBRATION, &saved, sizeof(saved))){
+    applyMagnetometerOffsets(saved.x, saved.y);
+  }
 
-  Serial.println("Adafruit_MMC5603 Magnetometer Test");
-  Serial.println("");
+  /* Initialise the sensor, if it is missing retryMagnetometer() keeps trying */
+  startSensor();
+}
 
-  /* Initialise the sensor */
-  if (!mmc.begin(MMC56X3_DEFAULT_ADDRESS, &Wire)) {  // I2C mode
-    /* There was a problem detecting the MMC5603 ... check your connections */
-    Serial.println("Ooops, no MMC5603 detected ... Check your wiring!");
-    while (1) delay(10);
+/******************************************************** 
+* Try a missing sensor again once its wait is over
+********************************************************/
+void retryMagnetometer(unsigned long now) {
+  if(sensorReady or now - lastTry < retryDelay){
+    return;
+  }
+  if(!startSensor()){
+    retryDelay = retryDelay * 2 > MAG_RETRY_MAX ? MAG_RETRY_MAX : retryDelay * 2;
+  }
+}
+
+bool magnetometerReady() {
+  return sensorReady;
+}
+
+/******************************************************** 
+* Start serial and send what goes out once, after the first frame
+********************************************************/
+void setupMagnetometerSerial() {
+  // Release builds leave the serial port alone, see Debug.h
+  if(SERIAL_OUTPUT){
+    halSerialBegin(115200);
+  }
+
+  if(DEBUG_MESSAGES){
+    halSerialPrintln("MMC5603 Magnetometer Test");
+    halSerialPrintln("");
   }
 
   /* Display some basic information on this sensor */
-  mmc.printSensorDetails();
+  if(DEBUG_MESSAGES){
+    if(sensorReady){
+      halMagPrintDetails();
+    }else{
+      /* There was a problem detecting the MMC5603 ... check your connections */
+      halSerialPrintln("Ooops, no MMC5603 detected ... Check your wiring!");
+    }
+  }
+
+  if(SEND_CAPTURE){
+    captureBegin();
+  }
 }
 
 /******************************************************** 
-* Read the contents from the magnetometer 
+* Work out the heading from a reading taken at ms, or us
 ********************************************************/
-float getMagnetometerData(bool debug_flag) {
-  // Get a new sensor event 
-  sensors_event_t event;
-  mmc.getEvent(&event);
-
-  if(debug_flag){
-    // Display the results (magnetic vector values are in micro-Tesla (uT))
-    // Serial.print("Uni:0.00,0.00,0.00,0.0000,0.0000,0.0000,");
-    Serial.print("X: ");
-    Serial.print(event.magnetic.x-OFFSET_X);
-    Serial.print(" ,");
-    Serial.print("Y: ");
-    Serial.print(event.magnetic.y-OFFSET_y);
-    Serial.print(" ,");
-    Serial.print("Z: ");
-    Serial.print(event.magnetic.z); //Not used 
-  }
-  
+static float headingFor(const MagSample &sample, unsigned long ms, unsigned long us) {
+  if(LATENCY_STATS){
+    latencySample(us);
+  }
+
+  if(SEND_CAPTURE){
+    captureSample(ms, sample);
+  }
+
+  PROFILE_BEGIN(PROFILE_HEADING);
+
+  // Back to micro-Tesla, the same numbers the Adafruit driver gave
+  float magnetic_x = sample.x * MAG_UT_PER_COUNT;
+  float magnetic_y = sample.y * MAG_UT_PER_COUNT;
+
   //Calculate angle
   float Pi = 3.14159;
-  float mag_y = event.magnetic.y-OFFSET_y;
-  float mag_x = event.magnetic.x-OFFSET_X;
+  float mag_y = magnetic_y-offsetY;
+  float mag_x = magnetic_x-offsetX;
 
   // Calculate the heading given that X is the heading
   float heading = (atan2(mag_x,mag_y) * 180) / Pi;
@@ -71,13 +174,102 @@ float getMagnetometerData(bool debug_flag) {
     heading = 360 + heading;
   }
 
-  if(debug_flag){
-    Serial.print(" Compass Heading: ");
-    Serial.println(heading);
-  }
+  PROFILE_END(PROFILE_HEADING);
 
-  // Delay before the next sample
-  delay(10);
+  if(SEND_TELEMETRY){
+    // Goes out with the next telemetry frame, see Telemetry.h
+    telemetryReading(sample, heading, ms);
+  }
 
   return heading;
-}
\ No newline at end of file
+}
+
+/******************************************************** 
+* Take readings on the timer from now on
+********************************************************/
+void startMagnetometerSampling(uint16_t period) {
+  samplePeriod = period;
+  if(sensorReady){
+    startSampling();
+  }
+}
+
+/******************************************************** 
+* The next reading the timer took, as a heading
+********************************************************/
+bool nextMagnetometerData(float &heading, unsigned long &taken) {
+  MagReading reading;
+
+  // Failed readings are skipped, so one does not hide those behind it
+  for(;;){
+    PROFILE_BEGIN(PROFILE_READ);
+    bool got = ringPop(ring, reading);
+    dropped += ringDropped(ring, droppedSeen);
+    PROFILE_END(PROFILE_READ);
+
+    if(!got){
+      return false;
+    }
+    if(reading.ok){
+      break;
+    }
+
+    // After MAG_FAILED_READINGS failed reads in a row restart the sensor,
+    // the timer carries on if it answers, otherwise retryMagnetometer()
+    // looks for it
+    if(++failedReadings == MAG_FAILED_READINGS and !startSensor()){
+      lostSensor();
+    }
+  }
+  failedReadings = 0;
+
+  taken = reading.us;
+  heading = headingFor(reading.sample, reading.ms, reading.us);
+  return true;
+}
+
+unsigned long magnetometerDropped() {
+  return dropped;
+}
+
+/******************************************************** 
+* Read the contents from the magnetometer, waiting for it
+********************************************************/
+float getMagnetometerData() {
+  if(!sensorReady){
+    return NAN;
+  }
+
+  // Get a new sensor event, after a failed read restart the sensor and
+  // try once more before giving up on it
+  MagSample sample = {0, 0, 0};
+  PROFILE_BEGIN(PROFILE_READ);
+  bool read = halMagRead(sample) or (startSensor() and halMagRead(sample));
+  PROFILE_END(PROFILE_READ);
+
+  if(!read){
+    lostSensor();
+    return NAN;
+  }
+  return headingFor(sample, halMillis(), halMicros());
+}
+
+/******************************************************** 
+* Hard iron offsets
+********************************************************/
+void applyMagnetometerOffsets(float x, float y){
+  offsetX = x;
+  offsetY = y;
+}
+
+void setMagnetometerOffsets(float x, float y){
+  applyMagnetometerOffsets(x, y);
+
+  CalibrationConfig saved = {x, y};
+  configSet(CONFIG_CALIBRATION, &saved, sizeof(saved));
+}
+
+void getMagnetometerOffsets(float &x, float &y){
+  x = offsetX;
+  y = offsetY;
+}
@@ -0,0 +1,117 @@
+/*--------------------------------------------------------------------
+File:   Needle physics
+
+Doc:  A spring pulls the shown needle angle toward the measured heading
+      and a damper bleeds off its speed, so the needle overshoots and
+      settles like the one in the game.
+
+      Angles are binary angles: 65536 is a full turn, so subtracting two
+      angles as int16 always gives the short way around. Position and
+      speed are Q16.16 binary angles, spring and damping are Q8.8. One
+      step is a handful of 32 bit multiplies, a few hundred cycles on
+      the ATmega328, and runs at a fixed PHYSICS_TICK_MS so the motion
+      does not depend on how fast loop() goes.
+--------------------------------------------------------------------*/
+#include <math.h>
+#include "NeedlePhysics.h"
+
+// Most steps run at once after a stall, beyond that time is dropped
+#define PHYSICS_MAX_STEPS 8
+
+static uint32_t position;   // Q16.16 binary angle
+static int32_t velocity;    // Q16.16 binary angle per tick
+static uint16_t target;     // binary angle
+static bool started = false;
+
+static uint8_t spring = PHYSICS_SPRING;
+static uint8_t damping = PHYSICS_DAMPING;
+static unsigned long lastTick;
+
+/******************************************************** 
+* Set the heading to pull toward. The first one places the needle directly.
+********************************************************/
+void physicsSetTarget(float heading){
+  if(not isfinite(heading)){
+    return;
+  }
+
+  // Wrap first, a heading past the int32_t range cannot be cast
+  heading = fmodf(heading, 360.0f);
+  target = (uint16_t)(int32_t)(heading * (65536.0f / 360.0f));
+
+  if(not started){
+    position = (uint32_t)target << 16;
+    velocity = 0;
+    started = true;
+  }
+}
+
+/******************************************************** 
+* Set spring and damping
+********************************************************/
+void physicsSetTuning(uint8_t newSpring, uint8_t newDamping){
+  spring = newSpring > 64 ? 64 : newSpring;
+  damping = newDamping;
+}
+
+/******************************************************** 
+* One semi-implicit Euler step
+********************************************************/
+static void integrate(){
+  int16_t error = target - (uint16_t)(position >> 16);
+
+  velocity += (int32_t)error * spring * 256;
+  velocity -= (velocity >> 8) * damping;
+  position += velocity;
+}
+
+/******************************************************** 
+* Catch up on the steps that are due
+********************************************************/
+bool physicsStep(unsigned long now){
+  if(not started){
+    lastTick = now;
+    return false;
+  }
+
+  unsigned long due = (now - lastTick) / PHYSICS_TICK_MS;
+  if(due == 0){
+    return false;
+  }
+  lastTick += due * PHYSICS_TICK_MS;
+
+  if(due > PHYSICS_MAX_STEPS){
+    due = PHYSICS_MAX_STEPS;
+  }
+
+  uint16_t before = position >> 16;
+  while(due--){
+    integrate();
+  }
+  return (uint16_t)(position >> 16) != before;
+}
+
+/******************************************************** 
+* Save and restore the state, for a warm restart
+********************************************************/
+void physicsSave(PhysicsState &out){
+  out.position = position;
+  out.velocity = velocity;
+  out.target = target;
+  out.started = started;
+}
+
+void physicsRestore(const PhysicsState &state, unsigned long now){
+  position = state.position;
+  velocity = state.velocity;
+  target = state.target;
+  started = state.started;
+  lastTick = now;
+}
+
+/******************************************************** 
+* Convert the needle position back to degrees
+********************************************************/
+float physicsHeading(){
+  return (uint16_t)(position >> 16) * (360.0f / 65536.0f);
+}
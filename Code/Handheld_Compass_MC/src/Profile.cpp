@@ -0,0 +1,101 @@
+/*--------------------------------------------------------------------
+File:   Hot path profiling
+
+Doc:  The table behind the probes in Profile.h and the report. Stats
+      are kept in Timer1 ticks and only turned into us for the report,
+      which prints whole numbers so no float printing is linked in.
+      Off the AVR Timer1 does not exist, the probes do nothing and the
+      report shows no runs.
+--------------------------------------------------------------------*/
+#include "Profile.h"
+#include "HAL.h"
+
+struct ProfileStats {
+  uint16_t count;
+  uint16_t min;
+  uint16_t max;
+  uint32_t sum;
+};
+
+static ProfileStats stats[PROFILE_STAGES];
+
+static const char *const stageNames[PROFILE_STAGES] = {
+  "read", "heading", "frame", "show", "idle"
+};
+
+#if defined(PROFILE) and defined(__AVR__)
+uint16_t profileStart[PROFILE_STAGES];
+uint16_t profileTicks[PROFILE_STAGES];
+#endif
+
+void profileReset(){
+  for(uint8_t s = 0; s < PROFILE_STAGES; s++){
+    stats[s].count = 0;
+    stats[s].min = 0xFFFF;
+    stats[s].max = 0;
+    stats[s].sum = 0;
+  }
+}
+
+void profileBegin(){
+#if defined(PROFILE) and defined(__AVR__)
+  // Normal mode, prescaler 8, undoing the 8 bit PWM the core sets up
+  TCCR1A = 0;
+  TCCR1B = _BV(CS11);
+  TCNT1 = 0;
+#endif
+  profileReset();
+}
+
+void profileCommit(){
+#if defined(PROFILE) and defined(__AVR__)
+  for(uint8_t s = 0; s < PROFILE_STAGES; s++){
+    uint16_t ticks = profileTicks[s];
+    if(ticks == 0){
+      continue;
+    }
+    profileTicks[s] = 0;
+
+    ProfileStats &st = stats[s];
+    // Stop at a full count so the sum can not wrap
+    if(st.count == 0xFFFF){
+      continue;
+    }
+    st.count++;
+    st.sum += ticks;
+    if(ticks < st.min){
+      st.min = ticks;
+    }
+    if(ticks > st.max){
+      st.max = ticks;
+    }
+  }
+#endif
+}
+
+/******************************************************** 
+* Print ticks as us, with the half when there is one
+********************************************************/
+static void printMicros(uint32_t ticks){
+  halSerialPrint((long)(ticks / PROFILE_TICKS_PER_US));
+  halSerialPrint(ticks % PROFILE_TICKS_PER_US ? ".5\t" : "\t");
+}
+
+void profileReport(){
+  halSerialPrintln("stage\tcount\tmin us\tavg us\tmax us");
+  for(uint8_t s = 0; s < PROFILE_STAGES; s++){
+    const ProfileStats &st = stats[s];
+    halSerialPrint(stageNames[s]);
+    halSerialPrint("\t");
+    halSerialPrint((long)st.count);
+    halSerialPrint("\t");
+    if(st.count == 0){
+      halSerialPrintln("-\t-\t-");
+      continue;
+    }
+    printMicros(st.min);
+    printMicros((st.sum + st.count / 2) / st.count);
+    printMicros(st.max);
+    halSerialPrintln();
+  }
+}
@@ -0,0 +1,139 @@
+/*--------------------------------------------------------------------
+File:   Needle rasterizer
+
+Doc:  Draws the needle as a line through the center LED (21) at any
+      angle instead of picking one of the hand drawn frames. The red
+      tip runs from the center to the edge of the board, a gray tail
+      runs TAIL_LENGTH LEDs behind it and a short gray cross guard sits
+      either side of the center, like the frames in Frames.cpp.
+
+      An LED lights in proportion to how close it is to the line, fading
+      to off one LED pitch away, so a needle between two LEDs lights
+      both at part brightness. The angle and distance of every LED from
+      the center are worked out from Layout.h at compile time, and the
+      per frame work is a few 8 bit multiplies
+      per LED with a quarter wave sine table.
+--------------------------------------------------------------------*/
+#include "Rasterizer.h"
+#include "Layout.h"
+
+// Distances are Q4.4 in LED pitches
+#define PITCH        16
+#define TAIL_LENGTH  (2 * PITCH)
+#define GUARD_LENGTH (PITCH + PITCH / 4)
+
+// sin() of 0 - 90 degrees in 64 steps, scaled to 255
+static const uint8_t sineTable[65] PROGMEM = {
+    0,   6,  13,  19,  25,  31,  37,  44,  50,  56,  62,  68,  74,
+   80,  86,  92,  98, 103, 109, 115, 120, 126, 131, 136, 142, 147,
+  152, 157, 162, 167, 171, 176, 180, 185, 189, 193, 197, 201, 205,
+  208, 212, 215, 219, 222, 225, 228, 231, 233, 236, 238, 240, 242,
+  244, 246, 247, 249, 250, 251, 252, 253, 254, 254, 255, 255, 255
+};
+
+// Both tables are in data line order
+struct LedPolar {
+  uint16_t angle[NUM_LEDS];   // binary angle, clockwise from the top
+  uint8_t radius[NUM_LEDS];   // Q4.4 pitches
+};
+
+/******************************************************** 
+* Angle and distance of every LED from the center LED, from the layout
+********************************************************/
+constexpr LedPolar makeLedPolar(){
+  LedPolar p = {};
+
+  // coord[] is already in data line order, see Layout.h
+  for(uint8_t i = 0; i < NUM_LEDS; i++){
+    int8_t dx = layoutTables.coord[i].x - LAYOUT_CENTER_X;
+    int8_t dy = LAYOUT_CENTER_Y - layoutTables.coord[i].y;
+
+    p.angle[i] = dx == 0 and dy == 0 ? 0 : layoutAngle(dx, dy);
+    p.radius[i] = layoutSqrt((uint32_t)(dx * dx + dy * dy) * PITCH * PITCH);
+  }
+  return p;
+}
+
+static const LedPolar ledPolar PROGMEM = makeLedPolar();
+
+/******************************************************** 
+* sin() of a binary angle, -255 to 255, interpolated between table steps
+********************************************************/
+static int16_t sine(uint16_t angle){
+  uint16_t p = angle & 0x3FFF;
+  if(angle & 0x4000){
+    p = 0x4000 - p;
+  }
+
+  uint8_t i = p >> 8;
+  int16_t v = pgm_read_byte(&sineTable[i]);
+  if(i < 64){
+    int16_t next = pgm_read_byte(&sineTable[i + 1]);
+    v += ((next - v) * (uint8_t)p) >> 8;
+  }
+
+  return (angle & 0x8000) ? -v : v;
+}
+
+/******************************************************** 
+* Fade from 255 on the line to 0 one pitch away
+********************************************************/
+static uint8_t coverage(int16_t distance){
+  if(distance < 0){
+    distance = -distance;
+  }
+  if(distance >= PITCH){
+    return 0;
+  }
+  return 255 - distance * (256 / PITCH);
+}
+
+/******************************************************** 
+* Draw the needle into the needle layer
+********************************************************/
+bool rasterizeNeedle(uint16_t angle, CRGB *needle, uint8_t *dirty){
+  bool changed = false;
+
+  for(uint8_t i = 0; i < NUM_LEDS; i++){
+    uint8_t r = pgm_read_byte(&ledPolar.radius[i]);
+    uint16_t delta = pgm_read_word(&ledPolar.angle[i]) - angle;
+
+    // Distance along the needle and across it, Q4.4
+    int16_t along = (r * sine(delta + 0x4000)) >> 8;
+    int16_t across = (r * sine(delta)) >> 8;
+
+    uint8_t red = 0;
+    uint8_t gray = 0;
+
+    if(r == 0){
+      red = 255;
+    }else if(along > 0){
+      red = coverage(across);
+    }else if(-along <= TAIL_LENGTH){
+      gray = coverage(across);
+    }
+
+    // Cross guard either side of the center
+    if(r != 0 and across <= GUARD_LENGTH and -across <= GUARD_LENGTH){
+      uint8_t guard = coverage(along);
+      if(guard > gray){
+        gray = guard;
+      }
+    }
+
+    CRGB color;
+    if(red >= gray){
+      color = CRGB(red, 0, 0);
+    }else{
+      color = CRGB(gray / 2, gray / 2, gray / 2);
+    }
+
+    if(needle[i] != color){
+      needle[i] = color;
+      dirty[i >> 3] |= 1 << (i & 7);
+      changed = true;
+    }
+  }
+
+  return changed;
+}
@@ -0,0 +1,124 @@
+/*--------------------------------------------------------------------
+File:   Binary telemetry
+
+Doc:  Packs a reading into the frame described in Telemetry.h, COBS
+      encodes it into the ring buffer and trickles the buffer out of the
+      serial port. A frame is 27 bytes on the wire, so even 100 frames a
+      second is under a quarter of what 115200 baud carries, and no
+      floats are formatted on the AVR.
+--------------------------------------------------------------------*/
+#include <math.h>
+#include "Telemetry.h"
+#include "Crc.h"
+#include "Pack.h"
+
+static uint8_t ring[TELEMETRY_BUFFER];
+static uint8_t head;   // next byte written
+static uint8_t tail;   // next byte sent
+
+static_assert((TELEMETRY_BUFFER & (TELEMETRY_BUFFER - 1)) == 0, "the ring index wraps with a mask");
+static_assert(TELEMETRY_BUFFER <= 256, "the ring index is a byte");
+static_assert(TELEMETRY_ENCODED < TELEMETRY_BUFFER, "a frame must fit in the ring");
+
+static bool haveReading;
+static unsigned long readingTime;
+static MagSample reading;
+static uint16_t readingHeading;
+
+static uint16_t sequence;
+static uint8_t dropped;
+
+/******************************************************** 
+* Bytes free in the ring, one is kept empty to tell full from empty
+********************************************************/
+static uint8_t ringFree(){
+  return (tail - head - 1) & (TELEMETRY_BUFFER - 1);
+}
+
+void telemetryReading(const MagSample &sample, float heading, unsigned long taken){
+  reading = sample;
+  readingTime = taken;
+  if(isnan(heading) or heading < 0 or heading >= 360){
+    readingHeading = TELEMETRY_NO_HEADING;
+  }else{
+    readingHeading = (uint16_t)(heading * 100);
+  }
+  haveReading = true;
+}
+
+/******************************************************** 
+* COBS encode the payload into the ring, ending with the 0
+********************************************************/
+static void ringFrame(const uint8_t *payload){
+  uint8_t codeAt = head;
+  uint8_t code = 1;
+  head = (head + 1) & (TELEMETRY_BUFFER - 1);
+
+  for(uint8_t i = 0; i < TELEMETRY_PAYLOAD; i++){
+    if(payload[i] == 0){
+      ring[codeAt] = code;
+      codeAt = head;
+      code = 1;
+    }else{
+      ring[head] = payload[i];
+      code++;
+    }
+    head = (head + 1) & (TELEMETRY_BUFFER - 1);
+  }
+  ring[codeAt] = code;
+  ring[head] = 0;
+  head = (head + 1) & (TELEMETRY_BUFFER - 1);
+}
+
+bool telemetrySend(uint16_t readMicros, uint16_t drawMicros, uint8_t frame){
+  if(!haveReading){
+    return false;
+  }
+  haveReading = false;
+
+  if(ringFree() < TELEMETRY_ENCODED){
+    sequence++;
+    if(dropped < 255){
+      dropped++;
+    }
+    return false;
+  }
+
+  uint8_t payload[TELEMETRY_PAYLOAD];
+  uint8_t *p = payload;
+  *p++ = TELEMETRY_VERSION;
+  p = put16(p, sequence++);
+  p = put32(p, readingTime);
+  p = put24(p, reading.x);
+  p = put24(p, reading.y);
+  p = put24(p, reading.z);
+  p = put16(p, readingHeading);
+  *p++ = frame;
+  p = put16(p, readMicros);
+  p = put16(p, drawMicros);
+  *p++ = dropped;
+  *p = crc8(payload, TELEMETRY_PAYLOAD - 1);
+  dropped = 0;
+
+  ringFrame(payload);
+  return true;
+}
+
+/******************************************************** 
+* Hand the serial port as much as it will take right now
+********************************************************/
+void telemetryPoll(){
+  while(head != tail){
+    size_t room = halSerialAvailableForWrite();
+    if(room == 0){
+      return;
+    }
+    // Up to the end of what is queued or of the ring
+    size_t count = head > tail ? head - tail : TELEMETRY_BUFFER - tail;
+    if(count > room){
+      count = room;
+    }
+    halSerialWrite(&ring[tail], count);
+    tail = (tail + count) & (TELEMETRY_BUFFER - 1);
+  }
+}
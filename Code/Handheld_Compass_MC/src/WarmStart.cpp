@@ -0,0 +1,59 @@
+/*--------------------------------------------------------------------
+File:   Warm restart
+
+Doc:  One WarmState lives in .noinit, which the C runtime neither
+      zeroes nor loads. Saving it is a few copies and a crc8() over 25
+      bytes, a few thousand cycles five times a second. The optiboot
+      bootloader on the Nano clears MCUSR before the sketch runs, so the
+      reset cause is not available and the magic word and CRC alone
+      tell a warm restart from power on.
+--------------------------------------------------------------------*/
+#include <stddef.h>
+#include "WarmStart.h"
+#include "HAL.h"
+#include "Crc.h"
+#include "LED.h"
+#include "Magnetometer.h"
+#include "NeedlePhysics.h"
+
+struct WarmState {
+  uint32_t magic;
+  float offsetX;
+  float offsetY;
+  PhysicsState physics;
+  uint8_t frame;            // See shownFrame()
+  uint8_t crc;              // crc8() of everything before it
+};
+
+#ifdef __AVR__
+#define NOINIT __attribute__((section(".noinit")))
+#else
+#define NOINIT
+#endif
+
+static WarmState warm NOINIT;
+
+static uint8_t warmCrc(){
+  return crc8(&warm, offsetof(WarmState, crc));
+}
+
+bool warmRestore(){
+  if(warm.magic != WARM_MAGIC or warm.crc != warmCrc()){
+    return false;
+  }
+
+  // Already saved when they were set, writing them again would only wear
+  // the EEPROM on every reset
+  applyMagnetometerOffsets(warm.offsetX, warm.offsetY);
+  physicsRestore(warm.physics, halMillis());
+  resumeNeedle(warm.frame);
+  return true;
+}
+
+void warmSave(){
+  warm.magic = WARM_MAGIC;
+  getMagnetometerOffsets(warm.offsetX, warm.offsetY);
+  physicsSave(warm.physics);
+  warm.frame = shownFrame();
+  warm.crc = warmCrc();
+}
@@ -0,0 +1,482 @@
+/*--------------------------------------------------------------------
+File:   HAL for the ATmega328
+
+Doc:  Maps HAL.h onto FastLED, the MMC5603 over the interrupt driven
+      TWI in Twi.h, the Arduino clock, avr-libc's EEPROM calls and
+      Serial.
+
+      A reading is a short chain of transactions, the trigger, status
+      reads until the measurement is in and the outputs, and
+      halMagPoll() queues the next one when the last is done, so the
+      CPU is free while the bus and the sensor work. Every step is
+      bounded: Twi.h gives up on a bus that stops for TWI_TIMEOUT_US, and
+      the status is read a fixed number of times, so a missing or stuck
+      sensor costs a failed reading instead of a hang. Starting the
+      sensor first clocks out any slave holding SDA low, which happens
+      when a reset lands in the middle of a read.
+
+      Timed sampling takes Timer2, so tone() and analogWrite() on pins
+      3 and 11 do not work while it runs. Nothing on the compass uses
+      them.
+--------------------------------------------------------------------*/
+#ifndef HAL_NATIVE
+
+#include <Arduino.h>
+#include <FastLED.h>
+#include <avr/eeprom.h>
+#include <avr/interrupt.h>
+#include <util/atomic.h>
+#include "HAL.h"
+#include "Board.h"
+#include "Bench.h"
+#include "Profile.h"
+#include "MMC5603.h"
+#include "Twi.h"
+#include "SampleRing.h"
+#include "Latency.h"
+#include "Debug.h"
+
+#define I2C_CLOCK 400000
+
+// The longest transaction, the 9 byte output read, holds the bus for
+// 276 us at I2C_CLOCK. FastLED keeps the interrupts off for a whole
+// show, 24 bits of 1.25 us per LED, and the bus stops until it is over.
+// Twi.h times out a bus that has not moved for this long, which a bus
+// that is not stuck never reaches however many shows come in a row
+#define TWI_READ_US    300
+#define LED_SHOW_US    (Board::numLeds * 24 * 5 / 4)
+#define TWI_TIMEOUT_US (TWI_READ_US + LED_SHOW_US)
+
+// Status polls MAG_POLL_US apart while a measurement runs, the slowest
+// takes 7 ms
+#define MAG_POLLS   20
+#define MAG_POLL_US 1000
+
+/******************************************************** 
+* LED sink
+********************************************************/
+void halLedBegin(CRGB *leds, uint8_t count){
+  FastLED.addLeds<WS2812, Board::dataPin, Board::colorOrder>(leds, count);
+}
+
+void halLedShow(){
+  BENCH_BEGIN(BENCH_LED_SHOW);
+  PROFILE_BEGIN(PROFILE_SHOW);
+  FastLED.show();
+  PROFILE_END(PROFILE_SHOW);
+  BENCH_END(BENCH_LED_SHOW);
+}
+
+/******************************************************** 
+* Magnetometer source
+********************************************************/
+// One transaction in flight at a time, read into magData
+static TwiTransaction magTransaction;
+static uint8_t magData[MMC5603_DATA_BYTES];
+
+// Where halMagPoll() is with a reading
+enum MagStep {
+  STEP_IDLE,
+  STEP_TRIGGER,             // Writing TM_M
+  STEP_MEASURING,           // Waiting to read the status again
+  STEP_STATUS,              // Reading the status
+  STEP_DATA                 // Reading the outputs
+};
+
+static MagStep magStep;
+static uint8_t magPolls;
+static unsigned long lastPoll;
+
+/******************************************************** 
+* Queue a register write or read through Twi.h
+********************************************************/
+static bool magQueue(uint8_t reg, uint8_t writeCount, uint8_t readCount){
+  magTransaction.address = MMC5603_ADDRESS;
+  magTransaction.reg = reg;
+  magTransaction.writeCount = writeCount;
+  magTransaction.readCount = readCount;
+  magTransaction.data = magData;
+  magTransaction.done = NULL;
+  return twiQueue(magTransaction);
+}
+
+/******************************************************** 
+* Wait for the transaction, for the calls that have nothing else to do
+********************************************************/
+static bool magWait(){
+  while(magTransaction.status == TWI_PENDING){
+    twiPoll();
+  }
+  if(LATENCY_STATS){
+    latencyBus(magTransaction.endUs - magTransaction.startUs);
+  }
+  return magTransaction.status == TWI_DONE;
+}
+
+static bool magWrite(uint8_t reg, uint8_t value){
+  magData[0] = value;
+  return magQueue(reg, 1, 0) and magWait();
+}
+
+static bool magRead(uint8_t reg, uint8_t *data, uint8_t count){
+  if(!magQueue(reg, 0, count) or !magWait()){
+    return false;
+  }
+  memcpy(data, magData, count);
+  return true;
+}
+
+/******************************************************** 
+* Free a bus held by a slave stuck mid byte: up to 9 clocks until it
+* lets go of SDA, then a stop. The pins are driven open drain, low or
+* let go to the pull ups.
+********************************************************/
+static void recoverBus(){
+  pinMode(SDA, INPUT_PULLUP);
+  pinMode(SCL, INPUT_PULLUP);
+  delayMicroseconds(5);
+
+  for(uint8_t i = 0; i < 9 and digitalRead(SDA) == LOW; i++){
+    digitalWrite(SCL, LOW);
+    pinMode(SCL, OUTPUT);
+    delayMicroseconds(5);
+    pinMode(SCL, INPUT_PULLUP);
+    delayMicroseconds(5);
+  }
+
+  // Stop: SDA rises while SCL is high
+  digitalWrite(SDA, LOW);
+  pinMode(SDA, OUTPUT);
+  delayMicroseconds(5);
+  pinMode(SDA, INPUT_PULLUP);
+  delayMicroseconds(5);
+}
+
+bool halMagBegin(){
+  twiEnd();
+  recoverBus();
+  twiBegin(I2C_CLOCK, TWI_TIMEOUT_US);
+  magStep = STEP_IDLE;
+
+  uint8_t id;
+  if(!magRead(MMC5603_PRODUCT_ID, &id, 1) or id != MMC5603_ID){
+    return false;
+  }
+  // The same start up as the Adafruit driver used
+  magWrite(MMC5603_CTRL1, MMC5603_SW_RESET);
+  delay(20);
+  magWrite(MMC5603_CTRL0, MMC5603_DO_SET);
+  delay(1);
+  magWrite(MMC5603_CTRL0, MMC5603_DO_RESET);
+  delay(1);
+  return magWrite(MMC5603_CTRL2, 0);
+}
+
+bool halMagRead(MagSample &out){
+  if(!halMagRequest()){
+    return false;
+  }
+  // Bounded by MAG_POLLS and the TWI timeout
+  MagStatus status;
+  while((status = halMagPoll(out)) == MAG_BUSY){
+  }
+  return status == MAG_READY;
+}
+
+/******************************************************** 
+* Trigger one measurement, halMagPoll() takes it from there
+********************************************************/
+bool halMagRequest(){
+  if(magStep != STEP_IDLE){
+    return false;
+  }
+  magData[0] = MMC5603_TM_M;
+  if(!magQueue(MMC5603_CTRL0, 1, 0)){
+    return false;
+  }
+  magStep = STEP_TRIGGER;
+  magPolls = 0;
+  return true;
+}
+
+/******************************************************** 
+* One step of a reading each time its transaction is done: the trigger,
+* a status read every MAG_POLL_US until the measurement is in, then the
+* outputs
+********************************************************/
+MagStatus halMagPoll(MagSample &out){
+  if(magStep == STEP_IDLE){
+    return MAG_FAILED;
+  }
+
+  if(magStep != STEP_MEASURING){
+    twiPoll();
+    if(magTransaction.status == TWI_PENDING){
+      return MAG_BUSY;
+    }
+    if(LATENCY_STATS){
+      latencyBus(magTransaction.endUs - magTransaction.startUs);
+    }
+    if(magTransaction.status != TWI_DONE){
+      magStep = STEP_IDLE;
+      return MAG_FAILED;
+    }
+  }
+
+  switch(magStep){
+  case STEP_STATUS:
+    if(magData[0] & MMC5603_MEAS_M_DONE){
+      if(!magQueue(MMC5603_XOUT0, 0, MMC5603_DATA_BYTES)){
+        break;
+      }
+      magStep = STEP_DATA;
+      return MAG_BUSY;
+    }
+    // Not yet, look again in a while
+    [[fallthrough]];
+  case STEP_TRIGGER:
+    lastPoll = micros();
+    magStep = STEP_MEASURING;
+    return MAG_BUSY;
+
+  case STEP_MEASURING:
+    if(micros() - lastPoll < MAG_POLL_US){
+      return MAG_BUSY;
+    }
+    if(magPolls++ == MAG_POLLS or !magQueue(MMC5603_STATUS, 0, 1)){
+      break;
+    }
+    magStep = STEP_STATUS;
+    return MAG_BUSY;
+
+  case STEP_DATA:
+    mmc5603Decode(magData, out);
+    magStep = STEP_IDLE;
+    return MAG_READY;
+
+  default:
+    break;
+  }
+
+  magStep = STEP_IDLE;
+  return MAG_FAILED;
+}
+
+/******************************************************** 
+* Timed sampling. Timer2 ticks every HAL_SAMPLE_TICK_MS: on one tick a
+* measurement is triggered, HAL_SAMPLE_MEASURE_MS later the status and
+* the outputs are queued, and the last transaction's done call hands the
+* reading to the ring, or asks for them again on the next tick if the
+* sensor is still measuring. None of it waits on anything.
+********************************************************/
+static SampleRing *sampleRing;
+static uint16_t sampleTicks;
+static uint16_t sampleCountdown;
+
+// Ticks until the status and outputs are read, 0 while not measuring,
+// and how many more times they may be read for this measurement
+static uint8_t sampleWait;
+static uint8_t sampleRetries;
+
+static MagReading sampleReading;
+static TwiTransaction sampleTrigger;
+static TwiTransaction sampleStatus;
+static TwiTransaction sampleData;
+static uint8_t sampleTriggerByte = MMC5603_TM_M;
+static uint8_t sampleStatusByte;
+static uint8_t sampleBytes[MMC5603_DATA_BYTES];
+
+static void sampleDone(TwiTransaction &t){
+  (void)t;
+  MagReading &r = sampleReading;
+  bool answered = sampleTrigger.status == TWI_DONE and sampleStatus.status == TWI_DONE and
+                  sampleData.status == TWI_DONE;
+
+  // The sensor is there but still measuring, look again on the next tick
+  if(answered and !(sampleStatusByte & MMC5603_MEAS_M_DONE) and sampleRetries){
+    sampleRetries--;
+    sampleWait = 1;
+    return;
+  }
+
+  r.ok = answered and (sampleStatusByte & MMC5603_MEAS_M_DONE);
+  if(r.ok){
+    mmc5603Decode(sampleBytes, r.sample);
+  }
+  if(sampleRing){
+    ringPush(*sampleRing, r);
+  }
+}
+
+static void sampleQueue(TwiTransaction &t){
+  if(!twiQueue(t)){
+    t.status = TWI_ERROR;
+    if(t.done){
+      t.done(t);
+    }
+  }
+}
+
+static void sampleSetup(TwiTransaction &t, uint8_t reg, uint8_t writeCount, uint8_t readCount,
+                        uint8_t *data, TwiDone done){
+  t.address = MMC5603_ADDRESS;
+  t.reg = reg;
+  t.writeCount = writeCount;
+  t.readCount = readCount;
+  t.data = data;
+  t.done = done;
+  t.status = TWI_DONE;
+}
+
+ISR(TIMER2_COMPA_vect){
+  // The interrupt is the only thing polling the bus while sampling
+  twiPoll();
+
+  if(--sampleCountdown == 0){
+    sampleCountdown = sampleTicks;
+    sampleReading.ms = millis();
+    sampleReading.us = micros();
+    sampleQueue(sampleTrigger);
+    sampleWait = HAL_SAMPLE_MEASURE_MS / HAL_SAMPLE_TICK_MS;
+    sampleRetries = HAL_SAMPLE_RETRIES;
+  }else if(sampleWait and --sampleWait == 0){
+    sampleQueue(sampleStatus);
+    sampleQueue(sampleData);
+  }
+}
+
+void halMagSampleStart(uint16_t period, SampleRing &ring){
+  halMagSampleStop();
+
+  sampleSetup(sampleTrigger, MMC5603_CTRL0, 1, 0, &sampleTriggerByte, NULL);
+  sampleSetup(sampleStatus, MMC5603_STATUS, 0, 1, &sampleStatusByte, NULL);
+  sampleSetup(sampleData, MMC5603_XOUT0, 0, MMC5603_DATA_BYTES, sampleBytes, sampleDone);
+  sampleTicks = period / HAL_SAMPLE_TICK_MS;
+  sampleCountdown = sampleTicks;
+  sampleWait = 0;
+  sampleRing = &ring;
+
+  // CTC at 16 MHz / 256 / 125 = 500 Hz. A tick is longer than the 1.4 ms
+  // FastLED keeps the interrupts off for, so none are lost to a show
+  TCCR2A = _BV(WGM21);
+  TCCR2B = _BV(CS22) | _BV(CS21);
+  OCR2A = 124;
+  TCNT2 = 0;
+  TIFR2 = _BV(OCF2A);
+  TIMSK2 = _BV(OCIE2A);
+}
+
+void halMagSampleStop(){
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE){
+    TIMSK2 = 0;
+    sampleRing = NULL;
+  }
+}
+
+void halMagPrintDetails(){
+  halSerialPrintln("Sensor: MMC5603 on I2C at 0x30");
+}
+
+/******************************************************** 
+* Clock
+********************************************************/
+unsigned long halMillis(){
+  return millis();
+}
+
+unsigned long halMicros(){
+  return micros();
+}
+
+void halDelay(unsigned long ms){
+  delay(ms);
+}
+
+/******************************************************** 
+* EEPROM
+********************************************************/
+uint8_t halEepromRead(uint16_t address){
+  return eeprom_read_byte((const uint8_t *)address);
+}
+
+bool halEepromReady(){
+  return eeprom_is_ready();
+}
+
+void halEepromWrite(uint16_t address, uint8_t value){
+  // Starts the write and returns, the hardware finishes it
+  eeprom_update_byte((uint8_t *)address, value);
+}
+
+/******************************************************** 
+* Serial sink, only in builds that send something, see Debug.h. The
+* others never mention Serial, so its buffers and interrupt stay out
+********************************************************/
+#if SERIAL_OUTPUT
+
+void halSerialBegin(unsigned long baud){
+  Serial.begin(baud);
+  while (!Serial)
+    delay(10); // will pause Zero, Leonardo, etc until serial console opens
+}
+
+size_t halSerialWrite(const uint8_t *data, size_t length){
+  return Serial.write(data, length);
+}
+
+size_t halSerialAvailableForWrite(){
+  return Serial.availableForWrite();
+}
+
+void halSerialPrint(const char *text){
+  Serial.print(text);
+}
+
+void halSerialPrint(double value){
+  Serial.print(value);
+}
+
+void halSerialPrint(long value){
+  Serial.print(value);
+}
+
+void halSerialPrintln(const char *text){
+  Serial.println(text);
+}
+
+int halSerialRead(){
+  return Serial.read();
+}
+
+#else
+
+void halSerialBegin(unsigned long){
+}
+
+size_t halSerialWrite(const uint8_t *, size_t){
+  return 0;
+}
+
+size_t halSerialAvailableForWrite(){
+  return 0;
+}
+
+void halSerialPrint(const char *){
+}
+
+void halSerialPrint(double){
+}
+
+void halSerialPrint(long){
+}
+
+void halSerialPrintln(const char *){
+}
+
+int halSerialRead(){
+  return -1;
+}
+
+#endif
+
+#endif
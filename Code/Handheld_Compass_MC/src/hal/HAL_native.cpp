@@ -0,0 +1,360 @@
+/*--------------------------------------------------------------------
+File:   HAL for the host
+
+Doc:  Mock backends behind HAL.h for the native build. Time is virtual
+      and only moves when the host program or halDelay() moves it, so a
+      run is repeatable. The magnetometer reads from a callback and the
+      LEDs report to one. Serial goes to stdout, the EEPROM is an array
+      that starts out erased.
+--------------------------------------------------------------------*/
+#ifdef HAL_NATIVE
+
+#include <stdio.h>
+#include <string.h>
+#include "NativeHAL.h"
+#include "MMC5603Sim.h"
+#include "SampleRing.h"
+
+static unsigned long clockUs;
+
+static CRGB *ledBuffer;
+static uint8_t ledCount;
+
+static NativeMagSource magSource;
+
+// A reading started with halMagRequest(), polled the way HAL_avr.cpp does
+#define MAG_POLLS   20
+#define MAG_POLL_US 1000
+static bool magPending;
+static uint8_t magPolls;
+static unsigned long lastPoll;
+
+// Timed sampling, see halMagSampleStart()
+static SampleRing *sampleRing;
+static uint16_t sampleTicks;
+static uint16_t sampleCountdown;
+static uint8_t sampleWait;
+static uint8_t sampleRetries;
+static MagReading sampleReading;
+static NativeShowHook showHook;
+static bool serialEcho = true;
+
+// Erased EEPROM reads 0xFF, a write keeps it busy for 3.4 ms
+#define EEPROM_WRITE_US 3400
+static uint8_t eeprom[HAL_EEPROM_BYTES];
+static bool eepromErased;
+static unsigned long eepromBusyUntil;
+
+static bool simWrite(uint8_t reg, uint8_t value);
+static bool simRead(uint8_t reg, uint8_t *data, uint8_t count);
+
+/******************************************************** 
+* Timed sampling on the virtual clock, the same steps as Timer2 takes in
+* HAL_avr.cpp. With a source set it is asked for the reading when the
+* outputs would be read
+********************************************************/
+static void sampleTick(){
+  if(--sampleCountdown == 0){
+    sampleCountdown = sampleTicks;
+    sampleReading.ms = halMillis();
+    sampleReading.us = halMicros();
+    sampleReading.ok = magSource or simWrite(MMC5603_CTRL0, MMC5603_TM_M);
+    sampleWait = HAL_SAMPLE_MEASURE_MS / HAL_SAMPLE_TICK_MS;
+    sampleRetries = HAL_SAMPLE_RETRIES;
+  }else if(sampleWait and --sampleWait == 0){
+    MagReading r = sampleReading;
+    if(magSource){
+      r.ok = magSource(halMillis(), r.sample);
+    }else{
+      uint8_t status = 0;
+      uint8_t b[MMC5603_DATA_BYTES];
+      bool answered = r.ok and simRead(MMC5603_STATUS, &status, 1) and simRead(MMC5603_XOUT0, b, sizeof(b));
+
+      // Still measuring, look again on the next tick
+      if(answered and !(status & MMC5603_MEAS_M_DONE) and sampleRetries){
+        sampleRetries--;
+        sampleWait = 1;
+        return;
+      }
+      r.ok = answered and (status & MMC5603_MEAS_M_DONE);
+      if(r.ok){
+        mmc5603Decode(b, r.sample);
+      }
+    }
+    ringPush(*sampleRing, r);
+  }
+}
+
+void halMagSampleStart(uint16_t period, SampleRing &ring){
+  sampleTicks = period / HAL_SAMPLE_TICK_MS;
+  sampleCountdown = sampleTicks;
+  sampleWait = 0;
+  sampleRing = &ring;
+}
+
+void halMagSampleStop(){
+  sampleRing = NULL;
+}
+
+/******************************************************** 
+* Hooks
+********************************************************/
+// Up to a ms at a time, so timed sampling sees every tick it passes
+static void advanceUs(unsigned long us){
+  while(us > 0){
+    unsigned long step = 1000UL - clockUs % 1000UL;
+    if(step > us){
+      step = us;
+    }
+    clockUs += step;
+    us -= step;
+    if(sampleRing and clockUs % 1000UL == 0 and halMillis() % HAL_SAMPLE_TICK_MS == 0){
+      sampleTick();
+    }
+  }
+}
+
+void halNativeAdvance(unsigned long ms){
+  advanceUs(ms * 1000UL);
+}
+
+void halNativeSetMagSource(NativeMagSource source){
+  magSource = source;
+}
+
+void halNativeOnShow(NativeShowHook hook){
+  showHook = hook;
+}
+
+void halNativeSerialEcho(bool on){
+  serialEcho = on;
+}
+
+uint8_t *halNativeEeprom(){
+  if(!eepromErased){
+    memset(eeprom, 0xFF, sizeof(eeprom));
+    eepromErased = true;
+  }
+  return eeprom;
+}
+
+void halNativeLedText(const CRGB *leds, uint8_t count, char *out){
+  for(uint8_t i = 0; i < count; i++){
+    if(leds[i].r and !leds[i].g and !leds[i].b){
+      out[i] = 'R';
+    }else if(!leds[i].r and !leds[i].g and leds[i].b){
+      out[i] = 'B';
+    }else if(leds[i].r or leds[i].g or leds[i].b){
+      out[i] = 'G';
+    }else{
+      out[i] = '.';
+    }
+  }
+  out[count] = '\0';
+}
+
+/******************************************************** 
+* LED sink
+********************************************************/
+void halLedBegin(CRGB *leds, uint8_t count){
+  ledBuffer = leds;
+  ledCount = count;
+}
+
+void halLedShow(){
+  if(showHook and ledBuffer){
+    showHook(ledBuffer, ledCount, halMillis());
+  }
+}
+
+/******************************************************** 
+* Magnetometer source
+********************************************************/
+static bool simWrite(uint8_t reg, uint8_t value){
+  simMagSetTime(halMillis());
+  bool ok = simMagStart(MMC5603_ADDRESS, false) and simMagWriteByte(reg) and simMagWriteByte(value);
+  simMagStop();
+  return ok;
+}
+
+static bool simRead(uint8_t reg, uint8_t *data, uint8_t count){
+  simMagSetTime(halMillis());
+  bool ok = simMagStart(MMC5603_ADDRESS, false) and simMagWriteByte(reg) and
+            simMagStart(MMC5603_ADDRESS, true);
+  for(uint8_t i = 0; ok and i < count; i++){
+    data[i] = simMagReadByte();
+  }
+  simMagStop();
+  return ok;
+}
+
+/******************************************************** 
+* Start the simulated MMC5603 the way HAL_avr.cpp starts the real one
+********************************************************/
+bool halMagBegin(){
+  magPending = false;
+
+  uint8_t id;
+  if(!simRead(MMC5603_PRODUCT_ID, &id, 1) or id != MMC5603_ID){
+    return false;
+  }
+  simWrite(MMC5603_CTRL1, MMC5603_SW_RESET);
+  halDelay(20);
+  simWrite(MMC5603_CTRL0, MMC5603_DO_SET);
+  halDelay(1);
+  simWrite(MMC5603_CTRL0, MMC5603_DO_RESET);
+  halDelay(1);
+  return simWrite(MMC5603_CTRL2, 0);
+}
+
+bool halMagRead(MagSample &out){
+  if(!halMagRequest()){
+    return false;
+  }
+  MagStatus status;
+  while((status = halMagPoll(out)) == MAG_BUSY){
+    halDelay(1);
+  }
+  return status == MAG_READY;
+}
+
+/******************************************************** 
+* A reading in steps like on the AVR: the trigger, a status read every
+* ms until the measurement is in, then the outputs. The transactions
+* themselves take no virtual time
+********************************************************/
+bool halMagRequest(){
+  if(magPending){
+    return false;
+  }
+  if(!magSource and !simWrite(MMC5603_CTRL0, MMC5603_TM_M)){
+    return false;
+  }
+  magPending = true;
+  magPolls = 0;
+  lastPoll = halMicros();
+  return true;
+}
+
+MagStatus halMagPoll(MagSample &out){
+  if(!magPending){
+    return MAG_FAILED;
+  }
+  if(magSource){
+    magPending = false;
+    return magSource(halMillis(), out) ? MAG_READY : MAG_FAILED;
+  }
+
+  if(halMicros() - lastPoll < MAG_POLL_US){
+    return MAG_BUSY;
+  }
+  lastPoll = halMicros();
+  uint8_t status;
+  if(magPolls++ == MAG_POLLS or !simRead(MMC5603_STATUS, &status, 1)){
+    magPending = false;
+    return MAG_FAILED;
+  }
+  if(!(status & MMC5603_MEAS_M_DONE)){
+    return MAG_BUSY;
+  }
+
+  magPending = false;
+  uint8_t b[MMC5603_DATA_BYTES];
+  if(!simRead(MMC5603_XOUT0, b, sizeof(b))){
+    return MAG_FAILED;
+  }
+  mmc5603Decode(b, out);
+  return MAG_READY;
+}
+
+void halMagPrintDetails(){
+  halSerialPrintln("Sensor: MMC5603 (simulated, see MMC5603Sim.h)");
+}
+
+/******************************************************** 
+* Clock
+********************************************************/
+unsigned long halMillis(){
+  return clockUs / 1000UL;
+}
+
+unsigned long halMicros(){
+  return clockUs;
+}
+
+void halDelay(unsigned long ms){
+  halNativeAdvance(ms);
+}
+
+/******************************************************** 
+* EEPROM
+********************************************************/
+uint8_t halEepromRead(uint16_t address){
+  return halNativeEeprom()[address];
+}
+
+bool halEepromReady(){
+  return (long)(clockUs - eepromBusyUntil) >= 0;
+}
+
+void halEepromWrite(uint16_t address, uint8_t value){
+  // Waiting for the last write, the sampling timer keeps running
+  if(!halEepromReady()){
+    advanceUs(eepromBusyUntil - clockUs);
+  }
+  if(halNativeEeprom()[address] == value){
+    return;
+  }
+  eeprom[address] = value;
+  eepromBusyUntil = clockUs + EEPROM_WRITE_US;
+}
+
+/******************************************************** 
+* Serial sink
+********************************************************/
+void halSerialBegin(unsigned long baud){
+  (void)baud;
+}
+
+size_t halSerialWrite(const uint8_t *data, size_t length){
+  if(serialEcho){
+    fwrite(data, 1, length, stdout);
+  }
+  return length;
+}
+
+size_t halSerialAvailableForWrite(){
+  // stdout never fills up, but pretend to be the AVR's 64 byte buffer
+  return 64;
+}
+
+void halSerialPrint(const char *text){
+  if(serialEcho){
+    fputs(text, stdout);
+  }
+}
+
+void halSerialPrint(double value){
+  // Two decimals, like Serial.print()
+  if(serialEcho){
+    printf("%.2f", value);
+  }
+}
+
+void halSerialPrint(long value){
+  if(serialEcho){
+    printf("%ld", value);
+  }
+}
+
+void halSerialPrintln(const char *text){
+  if(serialEcho){
+    puts(text);
+  }
+}
+
+int halSerialRead(){
+  return -1;
+}
+
+#endif
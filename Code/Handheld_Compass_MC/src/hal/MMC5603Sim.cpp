@@ -0,0 +1,461 @@
+/*--------------------------------------------------------------------
+File:   Simulated MMC5603
+
+Doc:  The register map of the MMC5603 as far as the firmware uses it:
+      single and continuous measurements, the 20 bit outputs, the
+      temperature, the status bits and software reset. A measurement is
+      taken from the field script at the time it completes, so what the
+      firmware reads depends on when it asks, like with the real part.
+      Noise, spikes and nacks come from a seeded generator so a run
+      repeats exactly. Host only, see MMC5603Sim.h.
+--------------------------------------------------------------------*/
+#ifndef __AVR__
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <vector>
+#include "MMC5603Sim.h"
+#include "Magnetometer.h"
+
+// Measurement time in ms for each bandwidth setting, rounded up
+static const uint8_t measureMs[4] = {7, 4, 2, 2};
+
+struct TracePoint {
+  unsigned long time;
+  float heading;
+};
+
+struct FieldScript {
+  float heading;
+  float spin;
+  float swing;
+  float swingPeriod;
+  float field;
+  float down;
+  float hard[3];
+  float soft[3][3];
+  float noise;
+  float spikeRate;
+  float spikeSize;
+  float temperature;
+  float temperatureRate;
+  float drift;
+  float nackRate;
+  float unplugStart;
+  float unplugEnd;
+  uint32_t seed;
+  std::vector<TracePoint> trace;
+};
+
+static FieldScript script;
+static uint32_t randomState;
+
+static bool configured;
+static uint8_t regs[0x40];
+static bool present = true;
+static bool unplugged;
+static unsigned long now;
+static unsigned long measurements;
+
+// Bus state
+static bool selected;
+static bool pointerNext;
+static uint8_t pointer;
+
+// A single measurement in flight, or when the next continuous one is due
+static bool magPending;
+static bool tempPending;
+static unsigned long magDone;
+static unsigned long tempDone;
+static bool continuous;
+static unsigned long nextContinuous;
+
+/********************************************************
+* Repeatable random numbers
+********************************************************/
+static float uniform(){
+  // xorshift32
+  randomState ^= randomState << 13;
+  randomState ^= randomState >> 17;
+  randomState ^= randomState << 5;
+  return (randomState >> 8) / 16777216.0f;
+}
+
+static float gaussian(){
+  float u = uniform();
+  float v = uniform();
+  if(u < 1e-7f){
+    u = 1e-7f;
+  }
+  return sqrtf(-2.0f * logf(u)) * cosf(2.0f * (float)M_PI * v);
+}
+
+/********************************************************
+* Field script
+********************************************************/
+static void defaults(){
+  script = FieldScript();
+  script.field = 40;
+  script.hard[0] = OFFSET_X;
+  script.hard[1] = OFFSET_y;
+  for(uint8_t i = 0; i < 3; i++){
+    script.soft[i][i] = 1;
+  }
+  script.temperature = 25;
+  script.seed = 1;
+}
+
+static bool loadTrace(const char *path){
+  FILE *in = fopen(path, "r");
+  if(!in){
+    return false;
+  }
+  char line[128];
+  TracePoint p;
+  while(fgets(line, sizeof(line), in)){
+    if(line[0] != '#' and sscanf(line, "%lu %f", &p.time, &p.heading) == 2){
+      script.trace.push_back(p);
+    }
+  }
+  fclose(in);
+  return !script.trace.empty();
+}
+
+/********************************************************
+* Read up to count numbers split by commas
+* @return how many were read
+********************************************************/
+static uint8_t numbers(const char *text, float *out, uint8_t count){
+  uint8_t n = 0;
+  while(n < count){
+    char *end;
+    out[n] = strtof(text, &end);
+    if(end == text){
+      break;
+    }
+    n++;
+    if(*end != ','){
+      break;
+    }
+    text = end + 1;
+  }
+  return n;
+}
+
+static bool setting(const char *key, const char *value){
+  float v[9];
+  uint8_t n = numbers(value, v, 9);
+
+  if(strcmp(key, "trace") == 0){
+    return loadTrace(value);
+  }
+  if(n == 0){
+    return false;
+  }
+  if(strcmp(key, "heading") == 0){
+    script.heading = v[0];
+  }else if(strcmp(key, "spin") == 0){
+    script.spin = v[0];
+  }else if(strcmp(key, "swing") == 0 and n == 2){
+    script.swing = v[0];
+    script.swingPeriod = v[1];
+  }else if(strcmp(key, "field") == 0){
+    script.field = v[0];
+  }else if(strcmp(key, "down") == 0){
+    script.down = v[0];
+  }else if(strcmp(key, "hard") == 0 and n == 3){
+    memcpy(script.hard, v, sizeof(script.hard));
+  }else if(strcmp(key, "soft") == 0 and n == 9){
+    memcpy(script.soft, v, sizeof(script.soft));
+  }else if(strcmp(key, "noise") == 0){
+    script.noise = v[0];
+  }else if(strcmp(key, "spikes") == 0 and n == 2){
+    script.spikeRate = v[0];
+    script.spikeSize = v[1];
+  }else if(strcmp(key, "temp") == 0 and n == 2){
+    script.temperature = v[0];
+    script.temperatureRate = v[1];
+  }else if(strcmp(key, "drift") == 0){
+    script.drift = v[0];
+  }else if(strcmp(key, "nack") == 0){
+    script.nackRate = v[0];
+  }else if(strcmp(key, "unplug") == 0 and n == 2){
+    script.unplugStart = v[0];
+    script.unplugEnd = v[1];
+  }else if(strcmp(key, "seed") == 0){
+    script.seed = (uint32_t)v[0];
+  }else{
+    return false;
+  }
+  return true;
+}
+
+static void resetRegisters(){
+  memset(regs, 0, sizeof(regs));
+  regs[MMC5603_PRODUCT_ID] = MMC5603_ID;
+  magPending = false;
+  tempPending = false;
+  continuous = false;
+}
+
+bool simMagConfigure(const char *text){
+  configured = true;
+  defaults();
+  resetRegisters();
+  measurements = 0;
+  bool ok = true;
+
+  if(text){
+    char *copy = strdup(text);
+    for(char *word = strtok(copy, " \t\n"); word; word = strtok(NULL, " \t\n")){
+      char *equals = strchr(word, '=');
+      if(!equals){
+        ok = false;
+        break;
+      }
+      *equals = '\0';
+      if(!setting(word, equals + 1)){
+        fprintf(stderr, "MMC5603 sim: bad setting %s=%s\n", word, equals + 1);
+        ok = false;
+        break;
+      }
+    }
+    free(copy);
+  }
+
+  randomState = script.seed ? script.seed : 1;
+  return ok;
+}
+
+/********************************************************
+* Where the script has the compass pointing at time t
+********************************************************/
+static float headingAt(unsigned long t){
+  float seconds = t / 1000.0f;
+  float heading = script.heading + script.spin * seconds;
+
+  if(script.swingPeriod > 0){
+    heading += script.swing * sinf(2.0f * (float)M_PI * seconds / script.swingPeriod);
+  }
+
+  const std::vector<TracePoint> &trace = script.trace;
+  if(!trace.empty()){
+    size_t i = 0;
+    while(i + 1 < trace.size() and trace[i + 1].time <= t){
+      i++;
+    }
+    heading = trace[i].heading;
+    if(i + 1 < trace.size() and t > trace[i].time){
+      // Interpolate the short way round
+      float turn = fmodf(trace[i + 1].heading - trace[i].heading + 540.0f, 360.0f) - 180.0f;
+      heading += turn * (t - trace[i].time) / (float)(trace[i + 1].time - trace[i].time);
+    }
+  }
+
+  heading = fmodf(heading, 360.0f);
+  return heading < 0 ? heading + 360.0f : heading;
+}
+
+static float temperatureAt(unsigned long t){
+  return script.temperature + script.temperatureRate * (t / 1000.0f);
+}
+
+/********************************************************
+* Take a magnetic measurement at time t into the output registers
+********************************************************/
+static void measure(unsigned long t){
+  float h = headingAt(t) * (float)M_PI / 180.0f;
+
+  // getMagnetometerData() takes atan2(x, y), so x goes with the sine
+  float earth[3] = {script.field * sinf(h), script.field * cosf(h), script.down};
+  float drift = script.drift * (temperatureAt(t) - 25.0f);
+  bool spike = script.spikeRate > 0 and uniform() < script.spikeRate;
+
+  for(uint8_t axis = 0; axis < 3; axis++){
+    float uT = script.hard[axis] + drift;
+    for(uint8_t k = 0; k < 3; k++){
+      uT += script.soft[axis][k] * earth[k];
+    }
+    if(script.noise > 0){
+      uT += script.noise * gaussian();
+    }
+    if(spike){
+      uT += script.spikeSize;
+    }
+
+    long raw = lroundf(uT * MMC5603_COUNTS_PER_UT) + MMC5603_ZERO;
+    raw = raw < 0 ? 0 : (raw > 0xFFFFF ? 0xFFFFF : raw);
+    regs[MMC5603_XOUT0 + axis * 2] = raw >> 12;
+    regs[MMC5603_XOUT0 + axis * 2 + 1] = raw >> 4;
+    regs[MMC5603_XOUT0 + 6 + axis] = (raw & 0x0F) << 4;
+  }
+
+  regs[MMC5603_STATUS] |= MMC5603_MEAS_M_DONE;
+  measurements++;
+}
+
+static void measureTemperature(unsigned long t){
+  // 0.8 C per count from -75 C
+  float counts = (temperatureAt(t) + 75.0f) / 0.8f;
+  regs[MMC5603_TOUT] = counts < 0 ? 0 : (counts > 255 ? 255 : (uint8_t)counts);
+  regs[MMC5603_STATUS] |= MMC5603_MEAS_T_DONE;
+}
+
+static unsigned long continuousPeriod(){
+  uint8_t odr = regs[MMC5603_ODR];
+  return odr ? (1000UL + odr - 1) / odr : 1000UL;
+}
+
+/********************************************************
+* Finish whatever measurements are due by now
+********************************************************/
+static void catchUp(){
+  if(magPending and now >= magDone){
+    magPending = false;
+    measure(magDone);
+  }
+  if(tempPending and now >= tempDone){
+    tempPending = false;
+    measureTemperature(tempDone);
+  }
+  if(continuous and now >= nextContinuous){
+    // Only the latest one can still be read, the others are overwritten
+    unsigned long period = continuousPeriod();
+    unsigned long missed = (now - nextContinuous) / period;
+    measurements += missed;
+    nextContinuous += missed * period;
+    measure(nextContinuous);
+    nextContinuous += period;
+  }
+}
+
+void simMagSetTime(unsigned long ms){
+  now = ms;
+  catchUp();
+}
+
+void simMagSetPresent(bool on){
+  present = on;
+}
+
+/********************************************************
+* Registers
+********************************************************/
+static void writeRegister(uint8_t reg, uint8_t value){
+  uint8_t bandwidth = regs[MMC5603_CTRL1] & MMC5603_BW_MASK;
+
+  switch(reg){
+    case MMC5603_CTRL0:
+      if(value & MMC5603_TM_M){
+        regs[MMC5603_STATUS] &= ~MMC5603_MEAS_M_DONE;
+        magPending = true;
+        magDone = now + measureMs[bandwidth];
+      }
+      if(value & MMC5603_TM_T){
+        regs[MMC5603_STATUS] &= ~MMC5603_MEAS_T_DONE;
+        tempPending = true;
+        tempDone = now + measureMs[bandwidth];
+      }
+      // The rest of CTRL0 acts once and reads back as 0
+      if(value & MMC5603_CMM_FREQ){
+        regs[reg] = MMC5603_CMM_FREQ;
+      }
+      break;
+
+    case MMC5603_CTRL1:
+      if(value & MMC5603_SW_RESET){
+        resetRegisters();
+      }else{
+        regs[reg] = value;
+      }
+      break;
+
+    case MMC5603_CTRL2:
+      regs[reg] = value;
+      continuous = (value & MMC5603_CMM_EN) and (regs[MMC5603_CTRL0] & MMC5603_CMM_FREQ);
+      nextContinuous = now + continuousPeriod();
+      break;
+
+    case MMC5603_STATUS:
+      // Writing a 1 clears a done bit
+      regs[reg] &= ~value;
+      break;
+
+    case MMC5603_PRODUCT_ID:
+      break;
+
+    default:
+      regs[reg] = value;
+      break;
+  }
+}
+
+/********************************************************
+* I2C
+********************************************************/
+bool simMagStart(uint8_t address, bool read){
+  if(!configured){
+    simMagConfigure(NULL);
+  }
+  selected = false;
+
+  // Off the bus for the unplug= window, and back from power on after it
+  bool out = now >= script.unplugStart * 1000 and now < script.unplugEnd * 1000;
+  if(unplugged and !out){
+    resetRegisters();
+  }
+  unplugged = out;
+
+  if(address != MMC5603_ADDRESS or !present or unplugged){
+    return false;
+  }
+  if(script.nackRate > 0 and uniform() < script.nackRate){
+    return false;
+  }
+  selected = true;
+  pointerNext = !read;
+  catchUp();
+  return true;
+}
+
+bool simMagWriteByte(uint8_t data){
+  if(!selected){
+    return false;
+  }
+  if(pointerNext){
+    pointer = data & 0x3F;
+    pointerNext = false;
+  }else{
+    writeRegister(pointer, data);
+    pointer = (pointer + 1) & 0x3F;
+  }
+  return true;
+}
+
+uint8_t simMagReadByte(){
+  if(!selected){
+    return 0xFF;
+  }
+  uint8_t data = regs[pointer];
+  pointer = (pointer + 1) & 0x3F;
+  return data;
+}
+
+void simMagStop(){
+  selected = false;
+}
+
+/********************************************************
+* What the simulation knows
+********************************************************/
+float simMagHeading(){
+  return headingAt(now);
+}
+
+unsigned long simMagMeasurements(){
+  return measurements;
+}
+
+#endif
@@ -0,0 +1,51 @@
+/*--------------------------------------------------------------------
+File:   Host entry point for the native build
+
+Doc:  Runs setup() and loop() against the native HAL with the clock
+      moving 1 ms per loop. The magnetometer is the simulated MMC5603,
+      set up with the field script from the command line, see
+      MMC5603Sim.h. By default it turns a full circle every 10 s. Each
+      time the LEDs change the time and the LEDs are printed, R for red,
+      G for gray, . for off. Built with -DTELEMETRY the LEDs go to
+      stderr instead, leaving stdout to the serial port, so
+      program | telemetry_decode works.
+
+      usage: program [seconds] ["field script"]
+--------------------------------------------------------------------*/
+#if defined(HAL_NATIVE) and not defined(PIO_UNIT_TESTING)
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "NativeHAL.h"
+#include "MMC5603Sim.h"
+
+/******************************************************** 
+* Print the LEDs each time they are shown
+********************************************************/
+static void printLeds(const CRGB *leds, uint8_t count, unsigned long now){
+  char line[256];
+  halNativeLedText(leds, count, line);
+#ifdef TELEMETRY
+  fprintf(stderr, "%8lu %s\n", now, line);
+#else
+  printf("%8lu %s\n", now, line);
+#endif
+}
+
+int main(int argc, char **argv){
+  unsigned long seconds = argc > 1 ? strtoul(argv[1], NULL, 10) : 10;
+  if(!simMagConfigure(argc > 2 ? argv[2] : "spin=36")){
+    return 2;
+  }
+
+  halNativeOnShow(printLeds);
+
+  setup();
+  while(halMillis() < seconds * 1000UL){
+    loop();
+    halNativeAdvance(1);
+  }
+  return 0;
+}
+
+#endif
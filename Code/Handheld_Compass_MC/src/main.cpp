@@ -6,19 +6,125 @@ File:   Minecraft Compass main file
 Doc:  
 --------------------------------------------------------------------*/
 #include <Arduino.h>
+#include "HAL.h"
 #include "LED.h"
 #include "Magnetometer.h"
+#include "Bench.h"
+#include "Telemetry.h"
+#include "Debug.h"
+#include "Profile.h"
+#include "Latency.h"
+#include "Boot.h"
+#include "WarmStart.h"
+#include "ConfigStore.h"
+
+// Time between compass readings in ms, a multiple of HAL_SAMPLE_TICK_MS
+#define SAMPLE_PERIOD 200
 
 void setup() { 
+  bootMark(BOOT_SETUP);
+  configBegin();
   setupLED();
+  bootMark(BOOT_LEDS);
+
+  // After a reset the old needle comes straight back, see WarmStart.h
+  bool warm = warmRestore();
+
   setupMagnetometer();
+  bootMark(BOOT_SENSOR);
+  setSearching(!magnetometerReady());
+
+  // Show the first heading now rather than one SAMPLE_PERIOD from now,
+  // the animation jumps straight to the first frame it is given
+  float heading = getMagnetometerData();
+  bootMark(BOOT_FIRST_READING);
+  compassHead(heading);
+  updateLED();
+  warmSave();
+
+  // Every reading after this one is taken on the timer
+  startMagnetometerSampling(SAMPLE_PERIOD);
+
+  // Serial and the diagnostics wait until the needle is up
+  setupMagnetometerSerial();
+  bootMark(BOOT_SERIAL);
+  if(DEBUG_MESSAGES or PROFILING){
+    halSerialPrintln(warm ? "warm restart" : "cold boot");
+    bootReport();
+  }
+
+  if(PROFILING){
+    profileBegin();
+  }
 }
 
 void loop() { 
-  //get compass heading and use the LEDs to display north
-  float heading = getMagnetometerData(false);
-  compassHead(heading);
+  BENCH_BEGIN(BENCH_LOOP);
+  PROFILE_BEGIN(PROFILE_IDLE);
+  bool sampled = false;
+
+  //the timer takes a compass reading every 0.2s, use the LEDs to display
+  //north for each one that came in
+  for(;;){
+    float heading;
+    unsigned long taken;
+    BENCH_BEGIN(BENCH_MAGNETOMETER);
+    bool got = nextMagnetometerData(heading, taken);
+    BENCH_END(BENCH_MAGNETOMETER);
+    if(!got){
+      break;
+    }
+    sampled = true;
+
+    unsigned long read = halMicros();
+    BENCH_BEGIN(BENCH_COMPASS_HEAD);
+    compassHead(heading);
+    BENCH_END(BENCH_COMPASS_HEAD);
+
+    if(SEND_TELEMETRY){
+      telemetrySend(read - taken, halMicros() - read, shownFrame());
+    }
+
+    warmSave();
+  }
+
+  //a missing sensor is tried again with a growing wait, the needle
+  //spins meanwhile
+  retryMagnetometer(halMillis());
+  setSearching(!magnetometerReady());
+
+  //keep the needle sweeping between readings
+  BENCH_BEGIN(BENCH_LED_UPDATE);
+  updateLED();
+  BENCH_END(BENCH_LED_UPDATE);
+
+  //save changed settings a byte at a time
+  configPoll(halMillis());
+
+  //send telemetry as the serial port makes room for it
+  if(SEND_TELEMETRY){
+    telemetryPoll();
+  }
+
+  if(!sampled){
+    PROFILE_END(PROFILE_IDLE);
+  }
+
+  //p prints the stage timings and latencies, r clears them, see Profile.h
+  if(PROFILING){
+    profileCommit();
+    int command = halSerialRead();
+    if(command == 'p'){
+      profileReport();
+      latencyReport();
+      halSerialPrint("readings dropped ");
+      halSerialPrint((long)magnetometerDropped());
+      halSerialPrintln();
+    }else if(command == 'r'){
+      profileReset();
+      latencyReset();
+    }
+  }
 
-  //refresh every 0.2ms
-  delay(200);
+  BENCH_END(BENCH_LOOP);
 }
\ No newline at end of file
@@ -0,0 +1,108 @@
+// compassHead() golden table, written by scripts/heading_oracle.py --record
+// and checked by test_main.cpp. Each run is the first and last heading
+// of a stretch that shows the same LEDs in layout order, see the LED
+// array in LED.cpp: R red, G gray, . off, - nothing shown
+#ifndef Golden_H
+#define Golden_H
+
+#include <math.h>
+
+struct GoldenRun {
+  float first;
+  float last;
+  const char *leds;
+};
+
+static const GoldenRun goldenRuns[] = {
+  {-INFINITY, 10.9899998f, "..........G.........GRG.........R.........R...."},
+  {10.9999962f, 11.6000004f, "-"},
+  {11.6000013f, 18.8999996f, "..........G.........GRG.........R........RR...."},
+  {18.9000015f, 19.1000004f, "..........G.........GRG.........R........R....."},
+  {19.1000023f, 20.6000004f, "..........G.........GRG.........RR.......R....."},
+  {20.6000023f, 33.4000015f, ".........GG.........GRG.........RR.......R....."},
+  {33.4000053f, 45.0f, ".........GG.........GRG.........RR......RR....."},
+  {45.0000038f, 45.2000008f, ".........G..........GRG..........R......R......"},
+  {45.2000046f, 51.5f, ".........G..........GRG..........RR.....R......"},
+  {51.5000038f, 54.7999992f, ".........G..........GRG..........RR....RR......"},
+  {54.8000031f, 57.2000008f, ".........G..........RRG..........RR....RR......"},
+  {57.2000046f, 59.2000008f, "........GG..........RRG..........RR....RR......"},
+  {59.2000046f, 65.0999985f, "........GG..........RRG..........RRR...R......."},
+  {65.1000061f, 66.6999969f, "........GG..........RRG..........RRR..RR......."},
+  {66.7000046f, 66.9000015f, "........GG..........RRG..........RRR..R........"},
+  {66.9000092f, 71.8000031f, "........GG..........RRG..........RRRR.........."},
+  {71.8000107f, 76.0999985f, "........G..G.......RRRGG.......G..RRR.........."},
+  {76.1000061f, 78.8000031f, "..........G........RRRGG........G.RRR.........."},
+  {78.8000107f, 79.0f, "..........G.......RRRRGG........G..RR.........."},
+  {79.0000076f, 81.8000031f, "..........G.......RRRRGG........G..RRR........."},
+  {81.8000107f, 82.0f, "..........G.......RRRRGG........G...RR........."},
+  {82.0000076f, 83.5999985f, "..........G......RRRRRGG........G...RR........."},
+  {83.6000061f, 83.8000031f, "..........G......RRRRRGG........G....R........."},
+  {83.8000107f, 96.1999969f, "..........G.....RRRRRRGG........G.............."},
+  {96.2000046f, 96.4000015f, "..........G....R.RRRRRGG........G.............."},
+  {96.4000092f, 98.0f, "..........G...RR.RRRRRGG........G.............."},
+  {98.0000076f, 98.1999969f, "..........G...RR..RRRRGG........G.............."},
+  {98.2000046f, 99.6999969f, "..........G..RRR..RRRRGG........G.............."},
+  {99.7000046f, 99.9000015f, "..........G..RR...RRRRGG........G.............."},
+  {99.9000092f, 101.400002f, "..........G..RR....RRRGG........G.............."},
+  {101.400009f, 104.0f, "..........G.RRR.....RRGG........G.............."},
+  {104.000008f, 108.300003f, ".........G..RRR....RRRGG......G..G............."},
+  {108.300011f, 113.099998f, "...........RRRR.....RRG.......GG..............."},
+  {113.100006f, 120.800003f, "...........RRR......RRG.......GG..............."},
+  {120.800011f, 122.199997f, "RR.........RR.......RRG.......GG..............."},
+  {122.200005f, 123.400002f, "RR.........RR.......RRG........G..............."},
+  {123.400009f, 129.100006f, "RR.........RR.......GRG........G..............."},
+  {129.100021f, 129.300003f, ".R.........RR.......GRG........G..............."},
+  {129.300018f, 135.0f, ".R.........R........GRG........G..............."},
+  {135.000015f, 145.699997f, ".R........RR........GRG........GG.............."},
+  {145.700012f, 155.100006f, "..R.......RR........GRG........GG.............."},
+  {155.100021f, 160.899994f, "..R.......RR........GRG.........G.............."},
+  {160.900009f, 161.100006f, "..R.......R.........GRG.........G.............."},
+  {161.100021f, 168.399994f, "..RR......R.........GRG.........G.............."},
+  {168.400009f, 168.999985f, "-"},
+  {169.0f, 191.599991f, "...R......R.........GRG.........G.............."},
+  {191.600006f, 198.899979f, "...RR.....R.........GRG.........G.............."},
+  {198.899994f, 199.099991f, "....R.....R.........GRG.........G.............."},
+  {199.100006f, 204.899979f, "....R....RR.........GRG.........G.............."},
+  {204.899994f, 214.299988f, "....R....RR.........GRG.........GG............."},
+  {214.300003f, 224.999985f, "....RR...RR.........GRG.........GG............."},
+  {225.0f, 225.199982f, ".....R...R..........GRG..........G............."},
+  {225.199997f, 236.599991f, ".....R..RR..........GRG..........G............."},
+  {236.600006f, 237.799988f, ".....R..RR..........GRR..........G............."},
+  {237.800003f, 239.199982f, ".....R..RR..........GRR..........GG............"},
+  {239.199997f, 246.899994f, ".......RRR..........GRR..........GG............"},
+  {246.900009f, 251.699982f, "......RRRR..........GRR..........GG............"},
+  {251.699997f, 255.999985f, "......RRR..G.......GGRRR.......G..G............"},
+  {256.0f, 258.599976f, "......RRR.G........GGRRR........G.............."},
+  {258.600006f, 258.799988f, "......RR..G........GGRRR........G.............."},
+  {258.800018f, 261.799988f, "......RR..G........GGRRRR.......G.............."},
+  {261.800018f, 261.999969f, ".......R..G........GGRRRR.......G.............."},
+  {262.0f, 263.699982f, ".......R..G........GGRRRRR......G.............."},
+  {263.700012f, 276.199982f, "..........G........GGRRRRRR.....G.............."},
+  {276.200012f, 276.399994f, "..........G........GGRRRRR.R....G.............."},
+  {276.400024f, 277.999969f, "..........G........GGRRRRR.RR...G.............."},
+  {278.0f, 278.199982f, "..........G........GGRRRR..RR...G.............."},
+  {278.200012f, 280.999969f, "..........G........GGRRRR..RRR..G.............."},
+  {281.0f, 281.199982f, "..........G........GGRRRR...RR..G.............."},
+  {281.200012f, 283.899994f, "..........G........GGRRR....RRR.G.............."},
+  {283.900024f, 288.199982f, ".........G..G......GGRRR....RRR..G............."},
+  {288.200012f, 293.099976f, "...........GG.......GRR.....RRRR..............."},
+  {293.100006f, 293.299988f, "...........GG.......GRR......RRR..............R"},
+  {293.300018f, 294.899994f, "...........GG.......GRR......RRR.............RR"},
+  {294.900024f, 300.799988f, "...........GG.......GRR......RRR.............R."},
+  {300.800018f, 302.799988f, "...........GG.......GRR.......RR............RR."},
+  {302.800018f, 305.199982f, "...........G........GRR.......RR............RR."},
+  {305.200012f, 308.499969f, "...........G........GRG.......RR............RR."},
+  {308.5f, 314.799988f, "...........G........GRG.......RR............R.."},
+  {314.800018f, 314.999969f, "...........G........GRG........R............R.."},
+  {315.0f, 326.599976f, "..........GG........GRG........RR..........RR.."},
+  {326.600006f, 339.399994f, "..........GG........GRG........RR..........R..."},
+  {339.400024f, 340.899994f, "..........G.........GRG........RR..........R..."},
+  {340.900024f, 341.099976f, "..........G.........GRG.........R..........R..."},
+  {341.100006f, 348.399994f, "..........G.........GRG.........R.........RR..."},
+  {348.400024f, INFINITY, "..........G.........GRG.........R.........R...."},
+};
+
+static const char goldenNegativeZero[] = "..........G.........GRG.........R.........R....";
+static const char goldenNaN[] = "-";
+
+#endif
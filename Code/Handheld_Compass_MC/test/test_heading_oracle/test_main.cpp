@@ -0,0 +1,143 @@
+/*--------------------------------------------------------------------
+File:   compassHead() against the golden table
+
+Doc:  golden.h holds the LEDs the original if/else chain in compassHead()
+      showed for every heading from 0 to 360 in 0.01 degree steps, the
+      floats either side of every frame boundary, NaN, the infinities
+      and headings outside 0 - 360, in layout order. Every one of those
+      headings is asked again here and must show the same LEDs, on any
+      board.
+
+      The frame ranges leave two gaps that select no frame, where the
+      needle is cleared but never shown, so the LEDs keep the last one.
+      They came with the measured ranges and are kept on purpose, the
+      gap tests pin them down to the float.
+--------------------------------------------------------------------*/
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <unity.h>
+#include "NativeHAL.h"
+#include "LED.h"
+#include "Frames.h"
+#include "golden.h"
+
+// The gaps, first and last float in each
+#define GAP_EAST_FIRST 10.9999847f
+#define GAP_EAST_LAST  11.6000004f
+#define GAP_WEST_FIRST 168.400009f
+#define GAP_WEST_LAST  168.999985f
+
+static char shown[NUM_LEDS + 1];
+static bool wasShown;
+
+/******************************************************** 
+* Keep whatever was sent to the LEDs, in layout order so the golden
+* table holds for every board
+********************************************************/
+static void capture(const CRGB *leds, uint8_t count, unsigned long now){
+  (void)now;
+  char line[NUM_LEDS + 1];
+  halNativeLedText(leds, count, line);
+  for(uint8_t i = 0; i < NUM_LEDS; i++){
+    shown[i] = line[boardLed(i)];
+  }
+  shown[NUM_LEDS] = '\0';
+  wasShown = true;
+}
+
+/******************************************************** 
+* The LEDs compassHead() shows for a heading, starting from a cleared
+* needle so the answer does not depend on the heading before it
+********************************************************/
+static const char *showFor(float heading){
+  // NaN lands in no range, which clears the needle
+  compassHead(NAN);
+  wasShown = false;
+  compassHead(heading);
+  return wasShown ? shown : "-";
+}
+
+static void checkHeading(float heading, const char *want){
+  char message[32];
+  snprintf(message, sizeof(message), "heading %.9g", heading);
+  TEST_ASSERT_EQUAL_STRING_MESSAGE(want, showFor(heading), message);
+}
+
+void setUp(){
+  setupLED();
+  setNeedleMode(NEEDLE_SNAP);
+  halNativeOnShow(capture);
+}
+
+void tearDown(){
+}
+
+/******************************************************** 
+* Both ends of every run and the 0.01 degree steps inside it
+********************************************************/
+static void testGolden(){
+  for(const GoldenRun &run : goldenRuns){
+    checkHeading(run.first, run.leds);
+    checkHeading(run.last, run.leds);
+
+    float from = isinf(run.first) ? -1 : run.first;
+    float to = isinf(run.last) ? 361 : run.last;
+    for(long step = ceilf(from * 100); step <= floorf(to * 100); step++){
+      float heading = step / 100.0f;
+      if(heading > run.first and heading < run.last){
+        checkHeading(heading, run.leds);
+      }
+    }
+  }
+}
+
+static void testSpecials(){
+  checkHeading(-0.0f, goldenNegativeZero);
+  checkHeading(NAN, goldenNaN);
+}
+
+/******************************************************** 
+* Whether a heading is in one of the two gaps
+********************************************************/
+static bool inGap(float heading){
+  return (heading >= GAP_EAST_FIRST and heading <= GAP_EAST_LAST) or
+         (heading >= GAP_WEST_FIRST and heading <= GAP_WEST_LAST);
+}
+
+static void checkGapEdge(float heading){
+  char message[32];
+  snprintf(message, sizeof(message), "heading %.9g", heading);
+  TEST_ASSERT_EQUAL_MESSAGE(inGap(heading), frameForHeading(heading) == FRAME_NONE, message);
+}
+
+/******************************************************** 
+* The gaps start and end exactly where they always have
+********************************************************/
+static void testGapEdges(){
+  const float edges[] = {GAP_EAST_FIRST, GAP_EAST_LAST, GAP_WEST_FIRST, GAP_WEST_LAST};
+
+  for(float edge : edges){
+    checkGapEdge(edge);
+    checkGapEdge(nextafterf(edge, -INFINITY));
+    checkGapEdge(nextafterf(edge, INFINITY));
+  }
+}
+
+/******************************************************** 
+* And there are no others
+********************************************************/
+static void testNoOtherGaps(){
+  for(long step = 0; step < 36000; step++){
+    checkGapEdge(step / 100.0f);
+  }
+}
+
+int main(){
+  UNITY_BEGIN();
+  RUN_TEST(testGolden);
+  RUN_TEST(testSpecials);
+  RUN_TEST(testGapEdges);
+  RUN_TEST(testNoOtherGaps);
+  return UNITY_END();
+}
@@ -0,0 +1,70 @@
+/*--------------------------------------------------------------------
+File:   Rasterizer against the frame table
+
+Doc:  At north, east, south and west the hand drawn frame is a straight
+      line of LEDs, so the rasterizer must light the same red LEDs as
+      the frame there. Both come out in data line order, each remapped
+      through Board.h once. With an identity board a table that is
+      remapped twice still passes, so run this with the reversed test
+      board as well:
+
+      pio test -e native -e native_reversed
+--------------------------------------------------------------------*/
+#include <stdio.h>
+#include <unity.h>
+#include "Rasterizer.h"
+#include "Frames.h"
+
+// Brighter than this counts as lit, the needle edge fades in below it
+#define LIT 128
+
+void setUp(){
+}
+
+void tearDown(){
+}
+
+/******************************************************** 
+* Compare the red LEDs of a frame and of the raster at an angle
+********************************************************/
+static void checkRed(uint8_t frame, uint16_t angle){
+  NeedleFrame f;
+  readFrame(frame, f);
+
+  CRGB needle[NUM_LEDS] = {};
+  uint8_t dirty[FRAME_BYTES] = {};
+  rasterizeNeedle(angle, needle, dirty);
+
+  char message[40];
+  for(uint8_t i = 0; i < NUM_LEDS; i++){
+    bool frameRed = f.red[i >> 3] & (1 << (i & 7));
+    bool rasterRed = needle[i].r >= LIT and needle[i].g == 0;
+    snprintf(message, sizeof(message), "frame %u, data line LED %u", frame, i);
+    TEST_ASSERT_EQUAL_MESSAGE(frameRed, rasterRed, message);
+  }
+}
+
+static void testNorth(){
+  checkRed(FRAME_NORTH, 0);
+}
+
+static void testEast(){
+  checkRed(frameForHeading(270), 0x4000);
+}
+
+static void testSouth(){
+  checkRed(FRAME_SOUTH, 0x8000);
+}
+
+static void testWest(){
+  checkRed(frameForHeading(90), 0xC000);
+}
+
+int main(){
+  UNITY_BEGIN();
+  RUN_TEST(testNorth);
+  RUN_TEST(testEast);
+  RUN_TEST(testSouth);
+  RUN_TEST(testWest);
+  return UNITY_END();
+}